@@ -0,0 +1,236 @@
+/*! @file bench.cpp
+    @brief Microbenchmarks of the kernels in a generation
+
+    Usage: `tek2-bench [filter] [seconds]`
+    writes JSON to stdout; only benchmarks whose names contain `filter` are run.
+*/
+#include "version.hpp"
+#include "population.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
+#include "dna.hpp"
+
+#include <sfmt.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! prevent the compiler from optimizing away a result
+template <class T> inline
+void keep(const T& x) {
+    __asm__ __volatile__("" : : "g"(&x) : "memory");
+}
+
+//! run functions repeatedly and write nanoseconds per call as JSON
+class Bench {
+  public:
+    Bench(std::ostream& ost, std::string filter, double seconds)
+    : ost_(ost), filter_(std::move(filter)), seconds_(seconds) {
+        ost_ << "{\"project\":\"" << tek::PROJECT_NAME
+             << "\",\"version\":\"" << tek::PROJECT_VERSION
+             << "\",\"seconds\":" << seconds_
+             << ",\"benchmarks\":[";
+    }
+    ~Bench() {
+        ost_ << "\n]}\n";
+    }
+
+    //! measure `fun()`; `args` is a JSON object describing the setting
+    template <class Fun>
+    void operator()(const std::string& name, const std::string& args, Fun&& fun) {
+        if (name.find(filter_) == std::string::npos) return;
+        std::cerr << name << " " << args << std::endl;
+        size_t n = 1u;
+        while (elapsed(fun, n) < 0.02 * seconds_ && n < (1u << 30u)) {n *= 2u;}
+        const size_t iterations = std::max<size_t>(1u, n * 10u / num_repeats_);
+        std::vector<double> ns_per_call;
+        for (size_t i=0u; i<num_repeats_; ++i) {
+            ns_per_call.push_back(1e9 * elapsed(fun, iterations) / iterations);
+        }
+        std::sort(ns_per_call.begin(), ns_per_call.end());
+        ost_ << (is_first_ ? "\n" : ",\n")
+             << "{\"name\":\"" << name << "\",\"args\":" << args
+             << ",\"iterations\":" << iterations
+             << ",\"ns\":{\"min\":" << ns_per_call.front()
+             << ",\"median\":" << ns_per_call[num_repeats_ / 2u]
+             << ",\"max\":" << ns_per_call.back() << "}}" << std::flush;
+        is_first_ = false;
+    }
+
+  private:
+    template <class Fun>
+    static double elapsed(Fun& fun, size_t n) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i=0u; i<n; ++i) fun();
+        const std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+        return d.count();
+    }
+
+    std::ostream& ost_;
+    const std::string filter_;
+    const double seconds_;
+    static constexpr size_t num_repeats_ = 5u;
+    bool is_first_ = true;
+};
+
+template <size_t N> inline
+tek::DNA<N> random_dna(uint_fast32_t num_mutations, tek::Haploid::URBG& engine) {
+    std::uniform_int_distribution<uint_fast32_t> unif(0u, N - 1u);
+    tek::DNA<N> x;
+    for (uint_fast32_t i=0u; i<num_mutations; ++i) {
+        x.flip(unif(engine), engine);
+    }
+    return x;
+}
+
+template <size_t N> inline
+void bench_dna(Bench& bench, tek::Haploid::URBG& engine) {
+    const auto x = random_dna<N>(N / 10u, engine);
+    const auto y = random_dna<N>(N / 10u, engine);
+    const std::string args = "{\"length\":" + std::to_string(N) + "}";
+    bench("DNA::operator-", args, [&x, &y] {keep(x - y);});
+    bench("DNA::count", args, [&x] {keep(x.count());});
+}
+
+//! Haploid of `n` TEs with their sites registered in the GP table
+inline tek::Haploid make_haploid(size_t n, const std::vector<std::shared_ptr<tek::Transposon>>& transposons,
+                                 tek::Haploid::URBG& engine) {
+    tek::Haploid x(n, transposons);
+    tek::Haploid::insert_coefs_gp(x, engine);
+    return x;
+}
+
+//! TEs of `num_species` species, and interaction coefficients among them
+inline std::vector<std::shared_ptr<tek::Transposon>>
+make_species(uint_fast32_t num_species, tek::Haploid::URBG& engine) {
+    std::vector<std::shared_ptr<tek::Transposon>> transposons;
+    for (uint_fast32_t i=0u; i<num_species; ++i) {
+        auto te = std::make_shared<tek::Transposon>();
+        for (uint_fast32_t j=0u; j<20u; ++j) te->mutate(engine);
+        if (i > 0u) te->speciate();
+        transposons.push_back(te);
+    }
+    tek::Transposon::INTERACTION_COEFS_clear();
+    for (const auto& x: transposons) {
+        for (const auto& y: transposons) {
+            if (x->species() < y->species()) {
+                tek::Transposon::INTERACTION_COEFS_emplace(x->species(), y->species(), *x * *y);
+            }
+        }
+    }
+    return transposons;
+}
+
+inline void bench_haploid(Bench& bench, tek::Haploid::URBG& engine) {
+    tek::Haploid::initialize(500u, tek::Population::THETA, tek::Population::RHO);
+    bench("Haploid::sample_chiasmata", "{}", [&engine] {
+        keep(tek::Haploid::sample_chiasmata(engine));
+    });
+    for (const uint_fast32_t num_species: {1u, 4u}) {
+        // reset the number of species so that one species takes the single-species path
+        tek::Transposon::initialize();
+        const auto transposons = make_species(num_species, engine);
+        for (const size_t copy_number: {1u, 10u, 100u, 1000u}) {
+            const std::string args = "{\"copy_number\":" + std::to_string(copy_number)
+                                   + ",\"species\":" + std::to_string(num_species) + "}";
+            const auto x = make_haploid(copy_number, transposons, engine);
+            const auto y = make_haploid(copy_number, transposons, engine);
+            bench("Haploid::gametogenesis", args, [&x, &y, &engine] {
+                keep(x.gametogenesis(y, engine));
+            });
+            bench("Haploid::fitness", args, [&x, &y] {
+                keep(x.fitness(y));
+            });
+            bench("Haploid::copy", args, [&x] {
+                keep(tek::Haploid(x));
+            });
+            // includes the copies measured by Haploid::copy
+            bench("Haploid::transpose_mutate", args, [&x, &y, &engine] {
+                tek::Haploid egg(x), sperm(y);
+                egg.transpose_mutate(sperm, engine);
+                keep(egg);
+            });
+        }
+    }
+}
+
+inline void bench_transposon(Bench& bench, tek::Haploid::URBG& engine) {
+    tek::Transposon te;
+    bench("Transposon::mutate", "{}", [&te, &engine] {
+        te.mutate(engine);
+        keep(te);
+    });
+    for (const size_t copy_number: {10u, 1000u}) {
+        tek::TransposonFamily family;
+        for (size_t i=0u; i<copy_number; ++i) {
+            tek::Transposon x;
+            for (uint_fast32_t j=0u; j<20u; ++j) x.mutate(engine);
+            family.collect(x);
+        }
+        const std::string args = "{\"copy_number\":" + std::to_string(copy_number) + "}";
+        bench("TransposonFamily::majority", args, [&family] {
+            keep(family.majority());
+        });
+    }
+}
+
+inline void bench_population(Bench& bench, tek::Haploid::URBG& engine) {
+    tek::Population::seed(42u);
+    for (const uint_fast32_t num_species: {1u, 4u}) {
+        for (const size_t popsize: {100u, 500u}) {
+            tek::Transposon::initialize();
+            const auto transposons = make_species(num_species, engine);
+            tek::Haploid::initialize(popsize, tek::Population::THETA, tek::Population::RHO);
+            // four founder TEs, one of each species in turn, on one chromosome of each individual
+            std::vector<tek::Haploid> gametes;
+            gametes.reserve(2u * popsize);
+            for (size_t i=0u; i<popsize; ++i) {
+                gametes.push_back(make_haploid(4u, transposons, engine));
+                gametes.emplace_back();
+            }
+            tek::Population pop(std::move(gametes));
+            for (size_t t=0u; t<200u; ++t) pop.step();
+            for (const size_t batch_size: {0u, 32u}) {
+                auto params = tek::Population::param();
+                params.BATCH_SIZE = batch_size;
+                tek::Population::param(params);
+                tek::Population x(pop);
+                const std::string args = "{\"popsize\":" + std::to_string(popsize)
+                                       + ",\"species\":" + std::to_string(num_species)
+                                       + ",\"burnin\":200,\"batch\":" + std::to_string(batch_size)
+                                       + ",\"transposons\":" + std::to_string(x.counts().transposons) + "}";
+                bench("Population::step", args, [&x] {
+                    keep(x.step());
+                });
+            }
+        }
+    }
+    auto params = tek::Population::param();
+    params.BATCH_SIZE = 0u;
+    tek::Population::param(params);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string filter = (argc > 1) ? argv[1] : "";
+    const double seconds = (argc > 2) ? std::stod(argv[2]) : 0.5;
+    tek::Haploid::URBG engine(42u);
+    Bench bench(std::cout, filter, seconds);
+    // activity and transposition rate are zero until parameters are set
+    tek::Transposon::initialize();
+    bench_dna<tek::Transposon::NUM_SYNONYMOUS_SITES>(bench, engine);
+    bench_dna<tek::Transposon::NUM_NONSYNONYMOUS_SITES>(bench, engine);
+    bench_dna<1000u>(bench, engine);
+    bench_dna<10000u>(bench, engine);
+    bench_transposon(bench, engine);
+    bench_haploid(bench, engine);
+    bench_population(bench, engine);
+    return 0;
+}
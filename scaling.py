@@ -0,0 +1,176 @@
+"""Measure throughput of tek2 over thread counts and population sizes.
+
+Scenarios take the first combination of the same-named presets in run.py
+with shorter runs.  Each population size is burned in once and saved with
+`--save`; every data point then starts from the snapshot with `--load` so
+that it measures the steady state rather than the establishment phase.
+
+A run that goes extinct restarts inside tek2 and its time covers
+more than the requested generations, so such data points are discarded
+and listed in scaling.json.
+
+Strong scaling keeps the population size fixed;
+weak scaling multiplies it by the number of threads.
+Results are written to scaling.json and scaling.tsv in --outdir.
+"""
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+import time
+
+SCENARIOS = {
+    'te2fig1': {'xi': '10e-4'},
+    'te2fig4': {'xi': '10e-4', 'H': '100'},
+    'te2fig5': {'xi': '10e-4', 'coexist': '2', 'lower': '6', 'upper': '18'},
+    'te2fig6': {'xi': '10e-4', 'coexist': '5', 'lower': '6', 'upper': '18'},
+}
+
+
+def make_args(options):
+    return ['--{}={}'.format(k, v) if len(k) > 1 else '-{}{}'.format(k, v)
+            for (k, v) in options.items()]
+
+
+def run(command, outdir, dry_run=False):
+    """Run tek2 and return elapsed seconds, peak RSS in bytes, and restarts"""
+    print(' '.join(command), file=sys.stderr)
+    if dry_run:
+        return (0.0, 0, 0)
+    log = outdir + '.log'
+    start = time.perf_counter()
+    with open(log, 'w') as ferr:
+        proc = subprocess.Popen(command + ['--outdir=' + outdir],
+                                stdout=subprocess.DEVNULL, stderr=ferr)
+        (_, status, rusage) = os.wait4(proc.pid, 0)
+    seconds = time.perf_counter() - start
+    if status != 0:
+        raise subprocess.CalledProcessError(status, command)
+    with open(log) as fin:
+        content = fin.read()
+    if 'runtime_error' in content:
+        sys.exit(content)
+    # printed by Population::evolve() before tek2 starts over
+    restarts = content.count('Extinction!') + content.count('Inactivation!')
+    # ru_maxrss is in kilobytes on Linux and in bytes on macOS
+    scale = 1 if sys.platform == 'darwin' else 1024
+    return (seconds, rusage.ru_maxrss * scale, restarts)
+
+
+def read_profile(path):
+    """Sum counters in profile.tsv written with --profile"""
+    totals = {'attempts': 0, 'acceptances': 0, 'transposons': 0}
+    with open(path) as fin:
+        for row in csv.DictReader(fin, delimiter='\t'):
+            for key in totals:
+                totals[key] += int(row[key])
+    return totals
+
+
+def measure(args, scenario, popsize, threads, snapshot, label):
+    options = dict(SCENARIOS[scenario])
+    options.update({'n': popsize, 'g': args.generations, 'i': args.generations + 1,
+                    'r': 0, 'j': threads, 'seed': args.seed})
+    command = [args.tek2, '--profile', '--load=' + snapshot] + make_args(options)
+    outdir = os.path.join(args.outdir, label)
+    (seconds, rss, restarts) = run(command, outdir, args.dry_run)
+    if args.dry_run:
+        return None
+    if restarts > 0:
+        print('Discarded {}: {} restarts'.format(label, restarts), file=sys.stderr)
+        return {'label': label, 'restarts': restarts}
+    counts = read_profile(os.path.join(outdir, 'profile.tsv'))
+    return {
+        'scenario': scenario,
+        'popsize': popsize,
+        'threads': threads,
+        'generations': args.generations,
+        'seconds': seconds,
+        'generations_per_sec': args.generations / seconds,
+        'attempts_per_sec': counts['attempts'] / seconds,
+        'acceptance_rate': counts['acceptances'] / max(counts['attempts'], 1),
+        'mean_copy_number': counts['transposons'] / max(2 * counts['acceptances'], 1),
+        'peak_rss': rss,
+    }
+
+
+def burn_in(args, scenario, popsize):
+    options = dict(SCENARIOS[scenario])
+    options.update({'n': popsize, 'g': args.burnin, 'i': args.burnin + 1,
+                    'r': 0, 'j': max(args.threads), 'seed': args.seed})
+    label = '{}_n{}_burnin'.format(scenario, popsize)
+    outdir = os.path.join(args.outdir, label)
+    command = [args.tek2, '--save=snapshot.bin.gz'] + make_args(options)
+    run(command, outdir, args.dry_run)
+    return os.path.abspath(os.path.join(outdir, 'snapshot.bin.gz'))
+
+
+def add_efficiency(records, weak):
+    """Efficiency relative to the smallest thread count in each group"""
+    groups = {}
+    for x in records:
+        key = (x['scenario'], x['popsize'] // x['threads'] if weak else x['popsize'])
+        groups.setdefault(key, []).append(x)
+    for group in groups.values():
+        base = min(group, key=lambda x: x['threads'])
+        for x in group:
+            ratio = x['threads'] / base['threads']
+            if weak:
+                x['efficiency'] = base['seconds'] / x['seconds']
+            else:
+                x['efficiency'] = base['seconds'] / (ratio * x['seconds'])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('scenarios', nargs='*', default=['te2fig1'],
+                        help='some of {} (default: te2fig1)'.format(', '.join(sorted(SCENARIOS))))
+    parser.add_argument('--tek2', default='tek2')
+    parser.add_argument('-j', '--threads', type=int, nargs='+', default=[1, 2, 4])
+    parser.add_argument('-n', '--popsize', type=int, nargs='+', default=[500])
+    parser.add_argument('--weak', action='store_true',
+                        help='multiply popsize by the number of threads')
+    parser.add_argument('-b', '--burnin', type=int, default=1000)
+    parser.add_argument('-g', '--generations', type=int, default=100)
+    parser.add_argument('--seed', type=int, default=42)
+    parser.add_argument('-o', '--outdir', default='scaling')
+    parser.add_argument('--dry-run', action='store_true')
+    args = parser.parse_args()
+    for x in args.scenarios:
+        if x not in SCENARIOS:
+            parser.error('unknown scenario: ' + x)
+    os.makedirs(args.outdir, exist_ok=True)
+    base_threads = min(args.threads)
+
+    records = []
+    discarded = []
+    for scenario in args.scenarios:
+        for n in args.popsize:
+            sizes = {j: n * j // base_threads if args.weak else n for j in args.threads}
+            snapshots = {x: burn_in(args, scenario, x) for x in sorted(set(sizes.values()))}
+            for (threads, popsize) in sizes.items():
+                label = '{}_n{}_j{}'.format(scenario, popsize, threads)
+                record = measure(args, scenario, popsize, threads, snapshots[popsize], label)
+                if record and 'restarts' in record:
+                    discarded.append(record)
+                elif record:
+                    records.append(record)
+    if args.dry_run:
+        return
+    add_efficiency(records, args.weak)
+
+    with open(os.path.join(args.outdir, 'scaling.json'), 'w') as fout:
+        json.dump({'weak': args.weak, 'records': records, 'discarded': discarded},
+                  fout, indent=2)
+    if records:
+        with open(os.path.join(args.outdir, 'scaling.tsv'), 'w') as fout:
+            writer = csv.DictWriter(fout, fieldnames=list(records[0]), delimiter='\t')
+            writer.writeheader()
+            writer.writerows(records)
+    print('End of ' + __file__)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,142 @@
+/*! @file bgzf.cpp
+    @brief Implementation of BgzfStream class
+*/
+#include "bgzf.hpp"
+
+#include <wtl/concurrent.hpp>
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace tek {
+
+namespace {
+//! gzip header with the BGZF extra field; BSIZE at 16 and 17
+constexpr unsigned char HEADER[] = {
+    0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0, 0
+};
+constexpr size_t HEADER_SIZE = sizeof(HEADER);
+constexpr size_t FOOTER_SIZE = 8u;
+constexpr size_t MAX_BLOCK_SIZE = 0x10000u;
+
+void put_le(std::string* out, size_t pos, uint32_t x, size_t width) {
+    for (size_t i = 0u; i < width; ++i) {
+        (*out)[pos + i] = static_cast<char>((x >> (8u * i)) & 0xffu);
+    }
+}
+
+//! return a complete gzip member
+std::string compress_block(const std::vector<char>& data) {
+    z_stream zs{};
+    if (::deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2() failed");
+    }
+    const auto bound = ::deflateBound(&zs, static_cast<uLong>(data.size()));
+    std::string out(HEADER_SIZE + bound + FOOTER_SIZE, '\0');
+    std::copy(std::begin(HEADER), std::end(HEADER), out.begin());
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&out[HEADER_SIZE]);
+    zs.avail_out = static_cast<uInt>(bound);
+    const int status = ::deflate(&zs, Z_FINISH);
+    const size_t compressed = zs.total_out;
+    ::deflateEnd(&zs);
+    if (status != Z_STREAM_END) throw std::runtime_error("deflate() failed");
+    const size_t size = HEADER_SIZE + compressed + FOOTER_SIZE;
+    if (size > MAX_BLOCK_SIZE) throw std::runtime_error("BGZF block overflow");
+    out.resize(size);
+    put_le(&out, 16u, static_cast<uint32_t>(size - 1u), 2u);
+    const auto crc = ::crc32(::crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data.data()),
+                             static_cast<uInt>(data.size()));
+    put_le(&out, size - 8u, static_cast<uint32_t>(crc), 4u);
+    put_le(&out, size - 4u, static_cast<uint32_t>(data.size()), 4u);
+    return out;
+}
+}
+
+BgzfBuffer::BgzfBuffer(const std::string& filename, wtl::ThreadPool* pool)
+: ofs_(filename, std::ios::binary),
+  filename_(filename),
+  pool_(pool),
+  block_(BLOCK_SIZE) {
+    if (!ofs_) throw std::runtime_error("cannot open " + filename);
+    setp(block_.data(), block_.data() + BLOCK_SIZE);
+}
+
+BgzfBuffer::~BgzfBuffer() {
+    try {
+        close();
+    } catch (...) {}  // call close() explicitly to catch errors
+}
+
+void BgzfBuffer::mark(const uint64_t key) {
+    if (!entries_.empty() && entries_.back().key == key) return;
+    if (pptr() == epptr()) submit();
+    entries_.push_back(Entry{key, num_blocks_, static_cast<uint64_t>(pptr() - pbase())});
+}
+
+BgzfBuffer::int_type BgzfBuffer::overflow(const int_type c) {
+    submit();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int BgzfBuffer::sync() {
+    while (!pending_.empty() &&
+           pending_.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        write_front();
+    }
+    return ofs_.flush() ? 0 : -1;
+}
+
+void BgzfBuffer::submit() {
+    std::vector<char> data(pbase(), pptr());
+    setp(block_.data(), block_.data() + BLOCK_SIZE);
+    ++num_blocks_;
+    if (pool_) {
+        pending_.push_back(pool_->submit([data = std::move(data)]() {
+            return compress_block(data);
+        }));
+        if (pending_.size() > 2u * pool_->size() + 2u) write_front();
+    } else {
+        std::promise<std::string> promise;
+        promise.set_value(compress_block(data));
+        pending_.push_back(promise.get_future());
+        write_front();
+    }
+}
+
+void BgzfBuffer::write_front() {
+    const std::string block = pending_.front().get();
+    pending_.pop_front();
+    offsets_.push_back(static_cast<uint64_t>(ofs_.tellp()));
+    ofs_.write(block.data(), static_cast<std::streamsize>(block.size()));
+    if (!ofs_) throw std::runtime_error("failed to write " + filename_);
+}
+
+void BgzfBuffer::close() {
+    if (closed_) return;
+    closed_ = true;
+    if (pptr() != pbase()) submit();
+    while (!pending_.empty()) write_front();
+    // a mark at the very end points to the EOF block
+    offsets_.push_back(static_cast<uint64_t>(ofs_.tellp()));
+    const auto eof = compress_block({});
+    ofs_.write(eof.data(), static_cast<std::streamsize>(eof.size()));
+    ofs_.close();
+    if (!ofs_) throw std::runtime_error("failed to write " + filename_);
+    if (entries_.empty()) return;
+    std::ofstream index(filename_ + ".idx");
+    index << "key\tcompressed_offset\twithin_block\n";
+    for (const auto& x: entries_) {
+        index << x.key << "\t" << offsets_[x.block] << "\t" << x.within << "\n";
+    }
+    if (!index) throw std::runtime_error("failed to write " + filename_ + ".idx");
+}
+
+} // namespace tek
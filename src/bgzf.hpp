@@ -0,0 +1,116 @@
+/*! @file bgzf.hpp
+    @brief Interface of BgzfStream class
+*/
+#pragma once
+#ifndef TEK_BGZF_HPP_
+#define TEK_BGZF_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace wtl {
+class ThreadPool;
+}
+
+namespace tek {
+
+/*! @brief Output buffer of BgzfStream
+
+    Each block is compressed as an independent gzip member
+    with the BGZF extra field, so the file is readable by gzip and bgzip.
+    Blocks are compressed on a thread pool, if given, and written in order.
+*/
+class BgzfBuffer: public std::streambuf {
+  public:
+    //! max number of uncompressed bytes per block
+    static constexpr size_t BLOCK_SIZE = 0xff00u;
+
+    //! open file; compress on the calling thread if `pool` is nullptr
+    BgzfBuffer(const std::string& filename, wtl::ThreadPool* pool);
+    //! call close() if not yet
+    ~BgzfBuffer();
+    //! noncopyable
+    BgzfBuffer(const BgzfBuffer&) = delete;
+
+    //! add an index entry at the current position unless `key` is the last one
+    void mark(uint64_t key);
+    //! write remaining blocks, EOF marker, and index
+    void close();
+
+  protected:
+    //! submit a full block
+    int_type overflow(int_type c) override;
+    //! write finished blocks without cutting the current one
+    int sync() override;
+
+  private:
+    //! position of a key
+    struct Entry {
+        //! key given to mark()
+        uint64_t key;
+        //! serial number of the block
+        uint64_t block;
+        //! offset in the uncompressed block
+        uint64_t within;
+    };
+    //! compress the current block
+    void submit();
+    //! write the oldest pending block
+    void write_front();
+
+    //! output file
+    std::ofstream ofs_;
+    //! name of output file
+    std::string filename_;
+    //! pool for compression; nullptr to compress in place
+    wtl::ThreadPool* pool_;
+    //! uncompressed data of the current block
+    std::vector<char> block_;
+    //! blocks being compressed in the order of submission
+    std::deque<std::future<std::string>> pending_;
+    //! number of blocks submitted
+    uint64_t num_blocks_ = 0u;
+    //! file offset of each written block
+    std::vector<uint64_t> offsets_;
+    //! index entries
+    std::vector<Entry> entries_;
+    //! set by close()
+    bool closed_ = false;
+};
+
+/*! @brief gzip-compatible output stream of BGZF blocks
+
+    An index `<filename>.idx` is written by close() if mark() was called.
+    Each row has a key and the compressed offset of its block,
+    from which the file can be decompressed as a standalone gzip stream,
+    and the number of bytes to skip in that block.
+*/
+class BgzfStream: public std::ostream {
+  public:
+    //! open file; compress on the calling thread if `pool` is nullptr
+    explicit BgzfStream(const std::string& filename, wtl::ThreadPool* pool = nullptr)
+    : std::ostream(nullptr), buf_(filename, pool) {rdbuf(&buf_);}
+    //! noncopyable
+    BgzfStream(const BgzfStream&) = delete;
+
+    //! add an index entry at the current position unless `key` is the last one
+    void mark(uint64_t key) {buf_.mark(key);}
+    //! write remaining blocks, EOF marker, and index
+    void close() {buf_.close();}
+
+  private:
+    //! buffer
+    BgzfBuffer buf_;
+};
+
+} // namespace tek
+
+#endif /* TEK_BGZF_HPP_ */
@@ -0,0 +1,37 @@
+/*! @file binary.hpp
+    @brief Read and write trivially copyable values in native byte order
+*/
+#pragma once
+#ifndef TEK_BINARY_HPP_
+#define TEK_BINARY_HPP_
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+//! write the bytes of x
+template <class T> inline
+std::ostream& write_pod(std::ostream& ost, const T& x) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    return ost.write(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+//! read a value written by write_pod()
+template <class T> inline
+T read_pod(std::istream& ist) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    T x;
+    if (!ist.read(reinterpret_cast<char*>(&x), sizeof(T))) {
+        throw std::runtime_error("unexpected end of binary input");
+    }
+    return x;
+}
+
+} // namespace tek
+
+#endif /* TEK_BINARY_HPP_ */
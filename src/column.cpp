@@ -0,0 +1,156 @@
+/*! @file column.cpp
+    @brief Implementation of ColumnWriter and ColumnReader classes
+*/
+#include "column.hpp"
+#include "binary.hpp"
+
+#include <zlib.h>
+
+namespace tek {
+
+namespace {
+constexpr char MAGIC[] = "TEKCOLS1";
+constexpr size_t MAGIC_SIZE = sizeof(MAGIC) - 1u;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+constexpr size_t TRAILER_SIZE = 2u * sizeof(uint64_t) + MAGIC_SIZE;
+}
+
+ColumnWriter::ColumnWriter(const std::string& filename, std::vector<ColumnSpec> columns)
+: columns_(std::move(columns)),
+  buffers_(columns_.size()) {
+    ofs_.exceptions(std::ios::failbit | std::ios::badbit);
+    ofs_.open(filename, std::ios::binary);
+    write(MAGIC, MAGIC_SIZE);
+    write(&BYTE_ORDER_MARK, sizeof(BYTE_ORDER_MARK));
+    const auto num_columns = static_cast<uint32_t>(columns_.size());
+    write(&num_columns, sizeof(num_columns));
+    for (const auto& spec: columns_) {
+        const auto name_size = static_cast<uint16_t>(spec.name.size());
+        write(&spec.type, sizeof(spec.type));
+        write(&spec.width, sizeof(spec.width));
+        write(&name_size, sizeof(name_size));
+        write(spec.name.data(), name_size);
+    }
+}
+
+ColumnWriter::~ColumnWriter() {
+    try {
+        close();
+    } catch (...) {}
+}
+
+void ColumnWriter::check_type(size_t j, bool matched) const {
+    if (!matched) {
+        throw std::invalid_argument("type mismatch: " + columns_[j].name);
+    }
+}
+
+void ColumnWriter::write(const void* data, size_t n) {
+    ofs_.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+    offset_ += n;
+}
+
+void ColumnWriter::write_chunk(const uint64_t generation) {
+    const uint64_t rows = columns_.empty() ? 0u : buffers_[0].size() / columns_[0].width;
+    for (size_t j=0u; j<columns_.size(); ++j) {
+        if (buffers_[j].size() != rows * columns_[j].width) {
+            throw std::runtime_error("inconsistent number of rows: " + columns_[j].name);
+        }
+    }
+    index_.push_back(generation);
+    index_.push_back(rows);
+    std::vector<Bytef> compressed;
+    for (auto& buffer: buffers_) {
+        uLongf size = compressBound(static_cast<uLong>(buffer.size()));
+        compressed.resize(size);
+        const auto status = compress2(compressed.data(), &size,
+            reinterpret_cast<const Bytef*>(buffer.data()), static_cast<uLong>(buffer.size()),
+            Z_DEFAULT_COMPRESSION);
+        if (status != Z_OK) {
+            throw std::runtime_error("compress2() failed");
+        }
+        index_.push_back(offset_);
+        index_.push_back(size);
+        write(compressed.data(), size);
+        buffer.clear();
+    }
+}
+
+void ColumnWriter::close() {
+    if (!ofs_.is_open()) return;
+    const uint64_t footer_offset = offset_;
+    const uint64_t num_chunks = index_.size() / (2u + 2u * columns_.size());
+    write(index_.data(), index_.size() * sizeof(uint64_t));
+    write(&footer_offset, sizeof(footer_offset));
+    write(&num_chunks, sizeof(num_chunks));
+    write(MAGIC, MAGIC_SIZE);
+    ofs_.close();
+}
+
+ColumnReader::ColumnReader(const std::string& filename) {
+    ifs_.exceptions(std::ios::failbit | std::ios::badbit);
+    ifs_.open(filename, std::ios::binary);
+    std::string magic(MAGIC_SIZE, '\0');
+    ifs_.read(&magic[0], MAGIC_SIZE);
+    if (magic != MAGIC) {
+        throw std::runtime_error("not a column file: " + filename);
+    }
+    if (read_pod<uint32_t>(ifs_) != BYTE_ORDER_MARK) {
+        throw std::runtime_error("incompatible byte order: " + filename);
+    }
+    const auto num_columns = read_pod<uint32_t>(ifs_);
+    for (uint32_t j=0u; j<num_columns; ++j) {
+        ColumnSpec spec;
+        spec.type = read_pod<char>(ifs_);
+        spec.width = read_pod<uint8_t>(ifs_);
+        spec.name.resize(read_pod<uint16_t>(ifs_));
+        ifs_.read(&spec.name[0], static_cast<std::streamsize>(spec.name.size()));
+        columns_.push_back(std::move(spec));
+    }
+    ifs_.seekg(-static_cast<std::streamoff>(TRAILER_SIZE), std::ios::end);
+    const auto footer_offset = read_pod<uint64_t>(ifs_);
+    const auto num_chunks = read_pod<uint64_t>(ifs_);
+    const size_t stride = 2u + 2u * columns_.size();
+    index_.resize(num_chunks * stride);
+    ifs_.seekg(static_cast<std::streamoff>(footer_offset));
+    ifs_.read(reinterpret_cast<char*>(index_.data()), static_cast<std::streamsize>(index_.size() * sizeof(uint64_t)));
+    for (size_t i=0u; i<num_chunks; ++i) {
+        chunks_.emplace(index_[i * stride], i * stride);
+    }
+}
+
+std::vector<uint64_t> ColumnReader::generations() const {
+    std::vector<uint64_t> v;
+    const size_t stride = 2u + 2u * columns_.size();
+    for (size_t i=0u; i<index_.size(); i+=stride) {
+        v.push_back(index_[i]);
+    }
+    return v;
+}
+
+size_t ColumnReader::find(const std::string& column) const {
+    for (size_t j=0u; j<columns_.size(); ++j) {
+        if (columns_[j].name == column) return j;
+    }
+    throw std::out_of_range("no such column: " + column);
+}
+
+std::vector<char> ColumnReader::read_raw(const size_t j, const uint64_t generation) {
+    const size_t row = chunks_.at(generation);
+    const uint64_t rows = index_[row + 1u];
+    const uint64_t offset = index_[row + 2u + 2u * j];
+    const uint64_t size = index_[row + 3u + 2u * j];
+    std::vector<Bytef> compressed(size);
+    ifs_.seekg(static_cast<std::streamoff>(offset));
+    ifs_.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(size));
+    std::vector<char> bytes(rows * columns_[j].width);
+    uLongf dest_size = static_cast<uLongf>(bytes.size());
+    const auto status = uncompress(reinterpret_cast<Bytef*>(bytes.data()), &dest_size,
+                                   compressed.data(), static_cast<uLong>(size));
+    if (status != Z_OK || dest_size != bytes.size()) {
+        throw std::runtime_error("uncompress() failed");
+    }
+    return bytes;
+}
+
+} // namespace tek
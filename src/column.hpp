@@ -0,0 +1,148 @@
+/*! @file column.hpp
+    @brief Interface of ColumnWriter and ColumnReader classes
+*/
+#pragma once
+#ifndef TEK_COLUMN_HPP_
+#define TEK_COLUMN_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <type_traits>
+#include <stdexcept>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+/*! @brief Name and type of a fixed-width column
+
+    File layout (native byte order):
+    - header: magic, byte-order mark, number of columns, and ColumnSpec
+    - chunks: each column of each chunk compressed separately with zlib
+    - footer: generation, rows, and (offset, size) of each column per chunk
+    - trailer: footer offset, number of chunks, and magic
+*/
+struct ColumnSpec {
+    //! column name
+    std::string name;
+    //! 'i' for signed integer, 'u' for unsigned integer, 'f' for floating point
+    char type;
+    //! number of bytes per value
+    uint8_t width;
+
+    //! make a spec for the type T
+    template <class T>
+    static ColumnSpec of(std::string name) {
+        static_assert(std::is_arithmetic<T>{}, "");
+        const char t = std::is_floating_point<T>{} ? 'f' : (std::is_signed<T>{} ? 'i' : 'u');
+        return ColumnSpec{std::move(name), t, static_cast<uint8_t>(sizeof(T))};
+    }
+    //! check if the type T matches
+    template <class T>
+    bool holds() const {
+        const auto spec = of<T>(name);
+        return spec.type == type && spec.width == width;
+    }
+};
+
+/*! @brief Writer of columnar binary records
+
+    Values are appended to per-column buffers as raw bytes,
+    which are compressed and written by write_chunk().
+*/
+class ColumnWriter {
+  public:
+    //! open file and write header
+    ColumnWriter(const std::string& filename, std::vector<ColumnSpec> columns);
+    //! call close() if not yet
+    ~ColumnWriter();
+    //! noncopyable
+    ColumnWriter(const ColumnWriter&) = delete;
+
+    //! append values to j-th column
+    template <class T>
+    void append(size_t j, const T* data, size_t n) {
+        check_type(j, columns_.at(j).holds<T>());
+        auto& buffer = buffers_[j];
+        const size_t size = buffer.size();
+        buffer.resize(size + n * sizeof(T));
+        std::memcpy(buffer.data() + size, data, n * sizeof(T));
+    }
+    //! append values to j-th column
+    template <class T>
+    void append(size_t j, const std::vector<T>& values) {
+        append(j, values.data(), values.size());
+    }
+    //! compress buffers and write them as a chunk
+    void write_chunk(uint64_t generation);
+    //! write footer and close file
+    void close();
+
+  private:
+    //! throw if false
+    void check_type(size_t j, bool matched) const;
+    //! write raw bytes and advance #offset_
+    void write(const void* data, size_t n);
+
+    //! column specs
+    const std::vector<ColumnSpec> columns_;
+    //! uncompressed values of the current chunk
+    std::vector<std::vector<char>> buffers_;
+    //! generation, rows, (offset, size) of each column, ...
+    std::vector<uint64_t> index_;
+    //! output file
+    std::ofstream ofs_;
+    //! current position in #ofs_
+    uint64_t offset_ = 0u;
+};
+
+/*! @brief Reader of columnar binary records
+
+    Only the footer is read on construction;
+    a column of a generation is read and decompressed on demand.
+*/
+class ColumnReader {
+  public:
+    //! read header and footer
+    explicit ColumnReader(const std::string& filename);
+
+    //! read a column of a chunk
+    template <class T>
+    std::vector<T> read(const std::string& column, uint64_t generation) {
+        const size_t j = find(column);
+        if (!columns_[j].holds<T>()) {
+            throw std::invalid_argument("type mismatch: " + column);
+        }
+        const auto bytes = read_raw(j, generation);
+        std::vector<T> values(bytes.size() / sizeof(T));
+        std::memcpy(values.data(), bytes.data(), bytes.size());
+        return values;
+    }
+    //! getter of #columns_
+    const std::vector<ColumnSpec>& columns() const {return columns_;}
+    //! generations in the order of chunks
+    std::vector<uint64_t> generations() const;
+
+  private:
+    //! return column index
+    size_t find(const std::string& column) const;
+    //! read and decompress j-th column of a chunk
+    std::vector<char> read_raw(size_t j, uint64_t generation);
+
+    //! column specs
+    std::vector<ColumnSpec> columns_;
+    //! generation => row of #index_
+    std::map<uint64_t, size_t> chunks_;
+    //! generation, rows, (offset, size) of each column, ...
+    std::vector<uint64_t> index_;
+    //! input file
+    std::ifstream ifs_;
+};
+
+} // namespace tek
+
+#endif /* TEK_COLUMN_HPP_ */
@@ -0,0 +1,178 @@
+/*! @file diversity.cpp
+    @brief Implementation of Diversity class
+*/
+#include "diversity.hpp"
+#include "haploid.hpp"
+
+#include <ostream>
+#include <random>
+#include <unordered_map>
+#include <algorithm>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+namespace {
+struct Hash {
+    size_t operator()(const Transposon* x) const noexcept {return x->hash();}
+};
+struct Equal {
+    bool operator()(const Transposon* x, const Transposon* y) const noexcept {return *x == *y;}
+};
+
+void add(Diversity::Sums* sums, uint_fast64_t pairs, uint_fast32_t nonsynonymous, uint_fast32_t synonymous) {
+    sums->pairs += pairs;
+    sums->nonsynonymous += pairs * nonsynonymous;
+    sums->synonymous += pairs * synonymous;
+    if (sums->distances.empty()) sums->distances.resize(LENGTH + 1u);
+    sums->distances[nonsynonymous + synonymous] += pairs;
+}
+}
+
+Diversity::Diversity(const std::vector<Haploid>& gametes, const size_t max_alleles, const uint_fast64_t seed) {
+    std::unordered_map<const Transposon*, uint_fast64_t, Hash, Equal> counter;
+    for (const auto& x: gametes) {
+        for (const auto& p: x) {
+            ++counter[p.second.get()];
+        }
+    }
+    if (counter.size() > max_alleles) {
+        std::vector<const Transposon*> pointers;
+        std::vector<uint_fast64_t> weights;
+        pointers.reserve(counter.size());
+        weights.reserve(counter.size());
+        for (const auto& p: counter) {
+            pointers.push_back(p.first);
+            weights.push_back(p.second);
+        }
+        std::mt19937_64 engine(seed);
+        std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+        std::unordered_map<const Transposon*, uint_fast64_t> sampled;
+        for (size_t i=0u; i<max_alleles; ++i) {
+            ++sampled[pointers[dist(engine)]];
+        }
+        counter.clear();
+        counter.insert(sampled.begin(), sampled.end());
+    }
+    alleles_.reserve(counter.size());
+    copies_.reserve(counter.size());
+    for (const auto& p: counter) {
+        alleles_.push_back(*p.first);
+        copies_.push_back(p.second);
+    }
+}
+
+Diversity::Partial Diversity::compare(const size_t first, const size_t stride) const {
+    Partial partial;
+    const size_t n = alleles_.size();
+    for (size_t i=first; i<n; i+=stride) {
+        const auto& x = alleles_[i];
+        const uint_fast64_t w = copies_[i];
+        if (w > 1u) {
+            add(&partial.within[x.species()], w * (w - 1u) / 2u, 0u, 0u);
+        }
+        for (size_t j=i+1u; j<n; ++j) {
+            const auto& y = alleles_[j];
+            // XOR and popcount over the two bit planes of each DNA
+            const uint_fast32_t dn = x.nonsynonymous_sites() - y.nonsynonymous_sites();
+            const uint_fast32_t ds = x.synonymous_sites() - y.synonymous_sites();
+            const uint_fast64_t pairs = w * copies_[j];
+            if (x.species() == y.species()) {
+                add(&partial.within[x.species()], pairs, dn, ds);
+            } else {
+                auto& sums = partial.between[std::minmax(x.species(), y.species())];
+                sums.pairs += pairs;
+                sums.nonsynonymous += pairs * dn;
+                sums.synonymous += pairs * ds;
+            }
+        }
+    }
+    return partial;
+}
+
+Diversity& Diversity::operator+=(const Partial& other) {
+    for (const auto& p: other.within) {
+        auto& sums = result_.within[p.first];
+        sums.pairs += p.second.pairs;
+        sums.nonsynonymous += p.second.nonsynonymous;
+        sums.synonymous += p.second.synonymous;
+        if (sums.distances.empty()) sums.distances.resize(LENGTH + 1u);
+        for (size_t d=0u; d<p.second.distances.size(); ++d) {
+            sums.distances[d] += p.second.distances[d];
+        }
+    }
+    for (const auto& p: other.between) {
+        auto& sums = result_.between[p.first];
+        sums.pairs += p.second.pairs;
+        sums.nonsynonymous += p.second.nonsynonymous;
+        sums.synonymous += p.second.synonymous;
+    }
+    return *this;
+}
+
+const char* Diversity::diversity_header() noexcept {
+    return "generation\tspecies\tcopy_number\talleles\tpi_n\tpi_s\tpi\n";
+}
+
+std::ostream& Diversity::write_diversity(std::ostream& ost, const size_t time) const {
+    std::map<uint_fast32_t, std::pair<uint_fast64_t, uint_fast64_t>> counts;
+    for (size_t i=0u; i<alleles_.size(); ++i) {
+        auto& x = counts[alleles_[i].species()];
+        x.first += copies_[i];
+        ++x.second;
+    }
+    for (const auto& p: counts) {
+        ost << time << "\t" << p.first << "\t" << p.second.first << "\t" << p.second.second;
+        const auto it = result_.within.find(p.first);
+        if (it == result_.within.end() || it->second.pairs == 0u) {
+            ost << "\tNA\tNA\tNA\n";
+            continue;
+        }
+        const auto& sums = it->second;
+        const double over_pairs = 1.0 / sums.pairs;
+        ost << "\t" << sums.nonsynonymous * over_pairs * Transposon::OVER_NONSYNONYMOUS_SITES
+            << "\t" << sums.synonymous * over_pairs * Transposon::OVER_SYNONYMOUS_SITES
+            << "\t" << (sums.nonsynonymous + sums.synonymous) * over_pairs / LENGTH << "\n";
+    }
+    return ost;
+}
+
+const char* Diversity::divergence_header() noexcept {
+    return "generation\tspecies_x\tspecies_y\tdn\tds\tdn_ds\n";
+}
+
+std::ostream& Diversity::write_divergence(std::ostream& ost, const size_t time) const {
+    for (const auto& p: result_.between) {
+        const auto& sums = p.second;
+        const double over_pairs = 1.0 / sums.pairs;
+        const double dn = sums.nonsynonymous * over_pairs * Transposon::OVER_NONSYNONYMOUS_SITES;
+        const double ds = sums.synonymous * over_pairs * Transposon::OVER_SYNONYMOUS_SITES;
+        ost << time << "\t" << p.first.first << "\t" << p.first.second
+            << "\t" << dn << "\t" << ds << "\t";
+        if (ds > 0.0) {
+            ost << dn / ds << "\n";
+        } else {
+            ost << "NA\n";
+        }
+    }
+    return ost;
+}
+
+const char* Diversity::distances_header() noexcept {
+    return "generation\tspecies\tdistance\tpairs\n";
+}
+
+std::ostream& Diversity::write_distances(std::ostream& ost, const size_t time) const {
+    for (const auto& p: result_.within) {
+        const auto& distances = p.second.distances;
+        for (size_t d=0u; d<distances.size(); ++d) {
+            if (distances[d] == 0u) continue;
+            ost << time << "\t" << p.first << "\t" << d << "\t" << distances[d] << "\n";
+        }
+    }
+    return ost;
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
@@ -0,0 +1,91 @@
+/*! @file diversity.hpp
+    @brief Interface of Diversity class
+*/
+#pragma once
+#ifndef TEK_DIVERSITY_HPP_
+#define TEK_DIVERSITY_HPP_
+
+#include "transposon.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <map>
+#include <utility>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+class Haploid;
+
+/*! @brief Pairwise sequence differences among TE copies
+
+    Unique alleles are weighted by copy number,
+    so that a pair of alleles stands for all pairs of their copies.
+    If there are more unique alleles than `max_alleles`,
+    that many copies are sampled with replacement instead.
+    Rows of the triangular comparison are split among threads by compare(),
+    and the partial sums are merged with operator+=().
+*/
+class Diversity {
+  public:
+    //! sums of differences over pairs of copies
+    struct Sums {
+        //! number of pairs
+        uint_fast64_t pairs = 0u;
+        //! sum of nonsynonymous differences
+        uint_fast64_t nonsynonymous = 0u;
+        //! sum of synonymous differences
+        uint_fast64_t synonymous = 0u;
+        //! number of pairs per Hamming distance; within species only
+        std::vector<uint_fast64_t> distances;
+    };
+    //! partial result of compare()
+    struct Partial {
+        //! species => sums within species
+        std::map<uint_fast32_t, Sums> within;
+        //! (species, species) => sums between species
+        std::map<std::pair<uint_fast32_t, uint_fast32_t>, Sums> between;
+    };
+
+    //! collect unique alleles in the gametes
+    Diversity(const std::vector<Haploid>& gametes, size_t max_alleles, uint_fast64_t seed);
+
+    //! compare alleles `first`, `first + stride`, ... with the following ones
+    Partial compare(size_t first, size_t stride) const;
+    //! merge a partial result
+    Diversity& operator+=(const Partial&);
+
+    //! number of unique alleles
+    size_t num_alleles() const noexcept {return alleles_.size();}
+
+    //! write copy number, alleles, and nucleotide diversity of each species
+    std::ostream& write_diversity(std::ostream&, size_t time) const;
+    //! write mean dn and ds between species
+    std::ostream& write_divergence(std::ostream&, size_t time) const;
+    //! write distribution of Hamming distance within species
+    std::ostream& write_distances(std::ostream&, size_t time) const;
+
+    //! header for write_diversity()
+    static const char* diversity_header() noexcept;
+    //! header for write_divergence()
+    static const char* divergence_header() noexcept;
+    //! header for write_distances()
+    static const char* distances_header() noexcept;
+
+  private:
+    //! unique alleles
+    std::vector<Transposon> alleles_;
+    //! copy number of each allele
+    std::vector<uint_fast64_t> copies_;
+    //! merged result
+    Partial result_;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_DIVERSITY_HPP_ */
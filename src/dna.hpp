@@ -10,6 +10,7 @@
 #include <valarray>
 #include <vector>
 #include <numeric>
+#include <functional>
 #include <iostream>
 
 /////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
@@ -80,6 +81,17 @@ class DNA {
         return ((this->is_pyrimidine_ ^ other.is_pyrimidine_) | (this->has_3bonds_ ^ other.has_3bonds_)).count();
     }
 
+    //! identical sequence
+    bool operator==(const DNA& other) const noexcept {
+        return has_3bonds_ == other.has_3bonds_ && is_pyrimidine_ == other.is_pyrimidine_;
+    }
+
+    //! hash value of sequence
+    size_t hash() const noexcept {
+        const size_t x = std::hash<std::bitset<N>>{}(has_3bonds_);
+        return x ^ (std::hash<std::bitset<N>>{}(is_pyrimidine_) + 0x9e3779b97f4a7c15u + (x << 6u) + (x >> 2u));
+    }
+
   private:
     //! translate integer to character
     static const char& translate(uint_fast8_t x) noexcept {
@@ -106,6 +118,15 @@ class Homolog {
         }
     }
 
+    Homolog& operator+=(const Homolog& other) noexcept {
+        for (uint_fast32_t i=0; i<N; ++i) {
+            for (uint_fast32_t j=0; j<4u; ++j) {
+                counts_[i][j] += other.counts_[i][j];
+            }
+        }
+        return *this;
+    }
+
     DNA<N> majority() const noexcept {
         std::valarray<uint_fast8_t> result(N);
         for (uint_fast32_t i=0; i<N; ++i) {
@@ -0,0 +1,107 @@
+/*! @file genealogy.cpp
+    @brief Implementation of Genealogy class
+*/
+#include "genealogy.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
+
+#include <ostream>
+#include <mutex>
+#include <unordered_set>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+namespace {
+std::mutex MTX;
+
+constexpr const char* ORIGIN_NAMES[] = {
+    "transposition",
+    "mutation",
+    "hyperactivation",
+};
+}
+
+std::unordered_map<uint_fast64_t, Genealogy::Node> Genealogy::NODES_;
+bool Genealogy::ENABLED_ = false;
+uint32_t Genealogy::GENERATION_ = 0u;
+
+void Genealogy::branch(Transposon& child, const Origin origin) {
+    if (!ENABLED_) return;
+    const auto parent = child.branch();
+    std::lock_guard<std::mutex> lock(MTX);
+    NODES_.emplace(child.id(), Node{parent, GENERATION_, 1u, origin});
+}
+
+std::unordered_map<uint_fast64_t, uint_fast32_t>
+Genealogy::count_live(const std::vector<Haploid>& gametes) {
+    std::unordered_map<uint_fast64_t, uint_fast32_t> live;
+    for (const auto& x: gametes) {
+        for (const auto& p: x) {
+            ++live[p.second->id()];
+        }
+    }
+    return live;
+}
+
+void Genealogy::simplify(const std::vector<Haploid>& gametes) {
+    const auto live = count_live(gametes);
+    std::unordered_map<uint_fast64_t, Node> kept;
+    kept.reserve(live.size());
+    for (const auto& p: live) {
+        auto id = p.first;
+        auto it = NODES_.find(id);
+        while (it != NODES_.end() && kept.emplace(id, it->second).second) {
+            id = it->second.parent;
+            it = NODES_.find(id);
+        }
+    }
+    std::unordered_map<uint_fast64_t, uint_fast32_t> num_children;
+    for (const auto& p: kept) {
+        ++num_children[p.second.parent];
+    }
+    std::unordered_set<uint_fast64_t> merged;
+    for (auto& p: kept) {
+        auto& node = p.second;
+        auto it = kept.find(node.parent);
+        while (it != kept.end() && live.count(it->first) == 0u && num_children[it->first] == 1u) {
+            merged.insert(it->first);
+            node.events += it->second.events;
+            node.parent = it->second.parent;
+            it = kept.find(node.parent);
+        }
+    }
+    for (const auto id: merged) {
+        kept.erase(id);
+    }
+    NODES_.swap(kept);
+}
+
+std::ostream& Genealogy::write(std::ostream& ost, const std::vector<Haploid>& gametes) {
+    const auto live = count_live(gametes);
+    ost << "id\tparent\tgeneration\torigin\tevents\tcopies\n";
+    for (const auto& p: NODES_) {
+        const auto& node = p.second;
+        const auto it = live.find(p.first);
+        ost << p.first << "\t" << node.parent << "\t" << node.generation << "\t"
+            << ORIGIN_NAMES[static_cast<unsigned int>(node.origin)] << "\t"
+            << node.events << "\t" << (it == live.end() ? 0u : it->second) << "\n";
+    }
+    for (const auto& p: live) {
+        if (NODES_.count(p.first) > 0u) continue;
+        ost << p.first << "\tNA\tNA\troot\t0\t" << p.second << "\n";
+    }
+    return ost;
+}
+
+size_t Genealogy::size() {
+    return NODES_.size();
+}
+
+void Genealogy::clear() {
+    NODES_.clear();
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
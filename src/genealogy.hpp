@@ -0,0 +1,85 @@
+/*! @file genealogy.hpp
+    @brief Interface of Genealogy class
+*/
+#pragma once
+#ifndef TEK_GENEALOGY_HPP_
+#define TEK_GENEALOGY_HPP_
+
+#include "length.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <unordered_map>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+class Haploid;
+class Transposon;
+
+/*! @brief Ancestry of TEs recorded during simulation
+
+    A node is a Transposon::id() created by transposition or copy-on-mutate.
+    simplify() removes lineages without live descendants,
+    and merges nonsampled nodes with a single child into their child edge.
+    Node 0 is the original TE; TEs read from a snapshot are also roots.
+*/
+class Genealogy {
+  public:
+    //! event that created a node
+    enum class Origin: uint8_t {
+        transposition,
+        mutation,
+        hyperactivation
+    };
+
+    //! give `child` a new id and record its parent if enabled()
+    static void branch(Transposon& child, Origin origin);
+    //! keep only the ancestors of TEs in the gametes
+    static void simplify(const std::vector<Haploid>& gametes);
+    //! write nodes and live roots; call simplify() beforehand
+    static std::ostream& write(std::ostream&, const std::vector<Haploid>& gametes);
+    //! number of nodes
+    static size_t size();
+    //! remove all nodes
+    static void clear();
+
+    //! run-time switch
+    static void enabled(bool x) noexcept {ENABLED_ = x;}
+    //! run-time switch
+    static bool enabled() noexcept {return ENABLED_;}
+    //! set the generation recorded by branch()
+    static void generation(uint32_t t) noexcept {GENERATION_ = t;}
+
+  private:
+    //! edge to parent
+    struct Node {
+        //! id of parent node
+        uint_fast64_t parent;
+        //! generation when this node was created
+        uint32_t generation;
+        //! number of events on the edge, including merged nodes
+        uint32_t events;
+        //! event that created this node
+        Origin origin;
+    };
+
+    //! id => copy number in the gametes
+    static std::unordered_map<uint_fast64_t, uint_fast32_t> count_live(const std::vector<Haploid>& gametes);
+
+    //! id => node
+    static std::unordered_map<uint_fast64_t, Node> NODES_;
+    //! run-time switch
+    static bool ENABLED_;
+    //! generation recorded by branch()
+    static uint32_t GENERATION_;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_GENEALOGY_HPP_ */
@@ -3,31 +3,58 @@
 */
 #include "haploid.hpp"
 #include "transposon.hpp"
+#include "textbuf.hpp"
+#include "profile.hpp"
+#include "binary.hpp"
+#include "genealogy.hpp"
 
 #include <wtl/debug.hpp>
 #include <wtl/iostr.hpp>
 #include <wtl/random.hpp>
 #include <sfmt.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 
 namespace tek {
 
+inline namespace TEK_LENGTH_NAMESPACE {
+
 Haploid::param_type Haploid::PARAM_;
 double Haploid::MUTATION_RATE_ = 0.0;
 double Haploid::RECOMBINATION_RATE_ = 0.0;
 double Haploid::INDEL_RATE_ = 0.0;
-std::unordered_map<Haploid::position_t, double> Haploid::SELECTION_COEFS_GP_;
-std::shared_ptr<Transposon> Haploid::ORIGINAL_TE_ = std::make_shared<Transposon>();
+Haploid::coefs_gp_type Haploid::SELECTION_COEFS_GP_;
+std::shared_ptr<Transposon> Haploid::ORIGINAL_TE_ = make_counted<Subsystem::transposons, Transposon>();
+
+namespace {
+//! number of chiasmata; may cache a normal deviate between calls
+thread_local std::poisson_distribution<uint_fast32_t> POISSON_CHIASMATA;
+//! number of mutations per TE; may cache a normal deviate between calls
+thread_local std::poisson_distribution<uint_fast32_t> POISSON_MUTATION;
+
+//! set the mean if it has been changed by Haploid::initialize()
+inline std::poisson_distribution<uint_fast32_t>&
+with_mean(std::poisson_distribution<uint_fast32_t>& dist, const double mean) {
+    if (dist.mean() != mean) {
+        dist.param(std::poisson_distribution<uint_fast32_t>::param_type(mean));
+    }
+    return dist;
+}
+
+//! table of selection coefficients private to this thread; see Haploid::use_coefs_gp()
+thread_local Haploid::coefs_gp_type* LOCAL_COEFS_GP = nullptr;
+}
 std::shared_timed_mutex Haploid::MTX_;
 
 /////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
 // static functions
 
-Haploid::Haploid(size_t n) {HERE;
+Haploid::Haploid(size_t n, const std::vector<std::shared_ptr<Transposon>>& transposons) {HERE;
     for (size_t i=0; i<n; ++i) {
-        sites_.emplace(static_cast<position_t>(wtl::sfmt64()()), ORIGINAL_TE_);
+        const auto& te = transposons.empty() ? ORIGINAL_TE_ : transposons[i % transposons.size()];
+        sites_.emplace(static_cast<position_t>(wtl::sfmt64()()), te);
     }
 }
 
@@ -42,16 +69,31 @@ void Haploid::initialize(const size_t popsize, const double theta, const double
     DCERR("RECOMBINATION_RATE_ = " << RECOMBINATION_RATE_ << std::endl);
 }
 
+void Haploid::use_coefs_gp(coefs_gp_type* table) noexcept {
+    LOCAL_COEFS_GP = table;
+}
+
+Haploid::coefs_gp_type& Haploid::coefs_gp() noexcept {
+    return LOCAL_COEFS_GP ? *LOCAL_COEFS_GP : SELECTION_COEFS_GP_;
+}
+
 Haploid::position_t Haploid::SELECTION_COEFS_GP_emplace(URBG& engine) {
     thread_local std::exponential_distribution<double> EXPO_DIST(1.0 / param().MEAN_SELECTION_COEF);
     thread_local std::bernoulli_distribution BERN_FUNCTIONAL(PROP_FUNCTIONAL_SITES_);
     auto coef = BERN_FUNCTIONAL(engine) ? EXPO_DIST(engine) : 0.0;
     position_t j = 0;
+    auto& coefs = coefs_gp();
     std::lock_guard<std::shared_timed_mutex> lock(MTX_);
-    while (!SELECTION_COEFS_GP_.emplace(j = static_cast<position_t>(engine()), coef).second) {;}
+    while (!coefs.emplace(j = static_cast<position_t>(engine()), coef).second) {;}
+    Profile::count(Event::gp_insertion);
     return j;
 }
 
+void Haploid::reset_thread_state() {
+    POISSON_CHIASMATA.reset();
+    POISSON_MUTATION.reset();
+}
+
 Haploid Haploid::copy_founder() {
     SELECTION_COEFS_GP_.emplace(0, 0.0);
     Haploid founder;
@@ -62,9 +104,13 @@ Haploid Haploid::copy_founder() {
 /////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
 
 Haploid Haploid::gametogenesis(const Haploid& other, URBG& engine) const {
+    const bool flg = (wtl::generate_canonical(engine) < 0.5);
+    return gametogenesis(other, flg, sample_chiasmata(engine).data());
+}
+
+Haploid Haploid::gametogenesis(const Haploid& other, bool flg, const position_t* chiasmata) const {
     constexpr position_t max_pos = std::numeric_limits<position_t>::max();
     Haploid gamete(*this);
-    bool flg = (wtl::generate_canonical(engine) < 0.5);
     auto gamete_it = gamete.sites_.begin();
     auto gamete_end = gamete.sites_.end();
     auto other_it = other.sites_.cbegin();
@@ -72,8 +118,7 @@ Haploid Haploid::gametogenesis(const Haploid& other, URBG& engine) const {
     position_t gamete_pos = (gamete_it != gamete_end) ? gamete_it->first : max_pos;
     position_t other_pos = (other_it != other_end) ? other_it->first : max_pos;
     position_t here = 0;
-    const auto chiasmata = sample_chiasmata(engine);
-    auto xit = chiasmata.begin();
+    auto xit = chiasmata;
     while ((here = std::min(gamete_pos, other_pos)) < max_pos) {
         while (*xit < here) {
             flg = !flg;
@@ -105,64 +150,76 @@ Haploid Haploid::gametogenesis(const Haploid& other, URBG& engine) const {
     return gamete;
 }
 
-std::set<Haploid::position_t> Haploid::sample_chiasmata(URBG& engine) {
-    thread_local std::poisson_distribution<uint_fast32_t> POISSON(RECOMBINATION_RATE_);
-    const uint_fast32_t n = POISSON(engine);
-    std::set<position_t> existing;
+const std::vector<Haploid::position_t>& Haploid::sample_chiasmata(URBG& engine) {
+    thread_local std::vector<position_t> chiasmata;
+    const uint_fast32_t n = with_mean(POISSON_CHIASMATA, RECOMBINATION_RATE_)(engine);
+    chiasmata.clear();
     if (wtl::generate_canonical(engine) < 0.5) {
         // assuming two chromosomes with the same lengths
-        existing.emplace(0);
+        chiasmata.push_back(0);
     }
     for (uint_fast32_t i = 0; i < n; ++i) {
-        while (!existing.emplace(static_cast<position_t>(engine())).second) {;}
+        position_t x = 0;
+        do {
+            x = static_cast<position_t>(engine());
+        } while (std::find(chiasmata.begin(), chiasmata.end(), x) != chiasmata.end());
+        chiasmata.push_back(x);
     }
+    std::sort(chiasmata.begin(), chiasmata.end());
     // sentinel for ending and safety in case n = 0
-    existing.emplace_hint(existing.end(), std::numeric_limits<position_t>::max());
-    return existing;
+    chiasmata.push_back(std::numeric_limits<position_t>::max());
+    return chiasmata;
 }
 
-std::vector<std::shared_ptr<Transposon>> Haploid::transpose(URBG& engine) {
-    std::vector<std::shared_ptr<Transposon>> copying_transposons;
+template <bool Excision>
+void Haploid::transpose(URBG& engine, std::vector<std::shared_ptr<Transposon>>* copying_transposons) {
     for (auto it=sites_.cbegin(); it!=sites_.cend();) {
         if (wtl::generate_canonical(engine) < it->second->transposition_rate()) {
-            copying_transposons.push_back(it->second);
+            copying_transposons->push_back(it->second);
         }
-        if (wtl::generate_canonical(engine) < param().EXCISION_RATE) {
+        if (Excision && wtl::generate_canonical(engine) < param().EXCISION_RATE) {
+            Profile::count(Event::excision);
             it = sites_.erase(it);
         } else {
             ++it;
         }
     }
-    return copying_transposons;
 }
 
+template <bool Excision>
 void Haploid::transpose_mutate(Haploid& other, URBG& engine) {
-    auto copying_transposons = this->transpose(engine);
-    {
-        auto tmp = other.transpose(engine);
-        copying_transposons.insert(copying_transposons.end(),
-            std::make_move_iterator(tmp.begin()),
-            std::make_move_iterator(tmp.end()));
-    }
+    thread_local std::vector<std::shared_ptr<Transposon>> copying_transposons;
+    this->transpose<Excision>(engine, &copying_transposons);
+    other.transpose<Excision>(engine, &copying_transposons);
+    Profile::count(Event::transposition, copying_transposons.size());
     for (auto& p: copying_transposons) {
         auto target_haploid = this;
         if (wtl::generate_canonical(engine) < 0.5) {
             target_haploid = &other;
         }
+        if (Genealogy::enabled()) {
+            p = make_counted<Subsystem::transposons, Transposon>(*p);
+            Genealogy::branch(*p, Genealogy::Origin::transposition);
+        }
         target_haploid->sites_.emplace(SELECTION_COEFS_GP_emplace(engine), std::move(p));
     }
+    copying_transposons.clear();
     this->mutate(engine);
     other.mutate(engine);
 }
+template void Haploid::transpose_mutate<true>(Haploid&, URBG&);
+template void Haploid::transpose_mutate<false>(Haploid&, URBG&);
 
 void Haploid::mutate(URBG& engine) {
-    thread_local std::poisson_distribution<uint_fast32_t> POISSON_MUT(MUTATION_RATE_);
+    auto& poisson_mut = with_mean(POISSON_MUTATION, MUTATION_RATE_);
     thread_local std::bernoulli_distribution BERN_INDEL(INDEL_RATE_);
     for (auto& p: sites_) {
-        const uint_fast32_t num_mutations = POISSON_MUT(engine);
+        const uint_fast32_t num_mutations = poisson_mut(engine);
         const bool is_deactivating = BERN_INDEL(engine);
         if (num_mutations > 0u || is_deactivating) {
-            p.second = std::make_shared<Transposon>(*p.second);
+            Profile::count(Event::mutation, num_mutations);
+            p.second = make_counted<Subsystem::transposons, Transposon>(*p.second);
+            Genealogy::branch(*p.second, Genealogy::Origin::mutation);
         }
         for (uint_fast32_t i=0u; i<num_mutations; ++i) {
             p.second->mutate(engine);
@@ -176,7 +233,8 @@ void Haploid::mutate(URBG& engine) {
 bool Haploid::hyperactivate() {
     for (auto& p: sites_) {
         if (p.second->activity() > 0.99) {
-            p.second = std::make_shared<Transposon>(*p.second);
+            p.second = make_counted<Subsystem::transposons, Transposon>(*p.second);
+            Genealogy::branch(*p.second, Genealogy::Origin::hyperactivation);
             p.second->hyperactivate();
             return true;
         }
@@ -186,46 +244,78 @@ bool Haploid::hyperactivate() {
 
 double Haploid::prod_1_zs() const {
     double product = 1.0;
+    const auto& coefs = coefs_gp();
     std::shared_lock<std::shared_timed_mutex> lock(MTX_);
     for (const auto& p: sites_) {
-        product *= (1.0 - SELECTION_COEFS_GP_.at(p.first));
+        product *= (1.0 - coefs.at(p.first));
     }
     return product;
 }
 
-double Haploid::fitness(const Haploid& other) const {
-    std::unordered_map<uint_fast32_t, uint_fast32_t> counter;
-    for (const auto& p: this->sites_) {
-        ++counter[p.second->species()];
-    }
-    for (const auto& p: other.sites_) {
-        ++counter[p.second->species()];
+double Haploid::prod_1_xi_n_tau(const uint_fast32_t copy_number) {
+    double product = 1.0;
+    if (copy_number > 0u) {
+        product *= (1.0 - param().XI * std::pow(copy_number, TAU_));
     }
-    double prod_1_xi_n_tau = 1.0;
+    return product;
+}
+
+double Haploid::prod_1_xi_n_tau(const std::vector<std::pair<uint_fast32_t, uint_fast32_t>>& counter) {
+    double product = 1.0;
     for (const auto& px: counter) {
         // within species
-        prod_1_xi_n_tau *= (1.0 - param().XI * std::pow(px.second, TAU_));
+        product *= (1.0 - param().XI * std::pow(px.second, TAU_));
         for (const auto& py: counter) {
             if (px.first < py.first) {
                 // between species
                 double coef = Transposon::INTERACTION_COEFS_get(px.first, py.first);
-                prod_1_xi_n_tau *= (1.0 - coef * param().XI * std::pow(px.second, 0.5 * TAU_) * std::pow(py.second, 0.5 * TAU_));
+                product *= (1.0 - coef * param().XI * std::pow(px.second, 0.5 * TAU_) * std::pow(py.second, 0.5 * TAU_));
             }
         }
     }
-    return std::max(prod_1_zs() * other.prod_1_zs() * prod_1_xi_n_tau, 0.0);
+    return product;
+}
+
+template <>
+double Haploid::fitness<false>(const Haploid& other) const {
+    // all TEs are in a single species
+    const uint_fast32_t copy_number = static_cast<uint_fast32_t>(sites_.size() + other.sites_.size());
+    return std::max(prod_1_zs() * other.prod_1_zs() * prod_1_xi_n_tau(copy_number), 0.0);
+}
+
+template <>
+double Haploid::fitness<true>(const Haploid& other) const {
+    // (species, copy number) in order of appearance; few species coexist
+    thread_local std::vector<std::pair<uint_fast32_t, uint_fast32_t>> counter;
+    counter.clear();
+    auto count = [](uint_fast32_t species) {
+        auto it = std::find_if(counter.begin(), counter.end(), [species](const auto& x) {
+            return x.first == species;
+        });
+        if (it == counter.end()) {
+            counter.emplace_back(species, 1u);
+        } else {
+            ++it->second;
+        }
+    };
+    for (const auto& p: this->sites_) {
+        count(p.second->species());
+    }
+    for (const auto& p: other.sites_) {
+        count(p.second->species());
+    }
+    return std::max(prod_1_zs() * other.prod_1_zs() * prod_1_xi_n_tau(counter), 0.0);
 }
 
-std::vector<std::string> Haploid::summarize() const {
+TextBuffer& Haploid::write_summary(TextBuffer& buffer) const {
     // "site:species:indel:nonsynonymous:synonymous:activity"
-    std::vector<std::string> v;
-    v.reserve(sites_.size());
+    buffer << '[';
+    const char* delimiter = "\"";
     for (const auto& p: sites_) {
-        std::ostringstream oss;
-        p.second->write_summary(oss << p.first << ":");
-        v.push_back(oss.str());
+        p.second->write_summary(buffer << delimiter << p.first << ':') << '"';
+        delimiter = ",\"";
     }
-    return v;
+    return buffer << ']';
 }
 
 std::ostream& Haploid::write_fasta(std::ostream& ost) const {
@@ -242,6 +332,44 @@ std::ostream& operator<<(std::ostream& ost, const Haploid& x) {
     return ost << x.sites_;
 }
 
+std::ostream& Haploid::write_binary(std::ostream& ost, const std::unordered_map<const Transposon*, uint32_t>& indices) const {
+    write_pod(ost, static_cast<uint64_t>(sites_.size()));
+    for (const auto& p: sites_) {
+        write_pod(ost, p.first);
+        write_pod(ost, indices.at(p.second.get()));
+    }
+    return ost;
+}
+
+Haploid Haploid::read_binary(std::istream& ist, const std::vector<std::shared_ptr<Transposon>>& transposons) {
+    Haploid x;
+    const auto n = read_pod<uint64_t>(ist);
+    for (uint64_t i=0u; i<n; ++i) {
+        const auto position = read_pod<position_t>(ist);
+        x.sites_.emplace_hint(x.sites_.end(), position, transposons.at(read_pod<uint32_t>(ist)));
+    }
+    return x;
+}
+
+std::ostream& Haploid::write_coefs_gp_binary(std::ostream& ost) {
+    write_pod(ost, static_cast<uint64_t>(SELECTION_COEFS_GP_.size()));
+    for (const auto& p: SELECTION_COEFS_GP_) {
+        write_pod(ost, p.first);
+        write_pod(ost, p.second);
+    }
+    return ost;
+}
+
+void Haploid::read_coefs_gp_binary(std::istream& ist) {
+    SELECTION_COEFS_GP_.clear();
+    const auto n = read_pod<uint64_t>(ist);
+    SELECTION_COEFS_GP_.reserve(n);
+    for (uint64_t i=0u; i<n; ++i) {
+        const auto position = read_pod<position_t>(ist);
+        SELECTION_COEFS_GP_.emplace(position, read_pod<double>(ist));
+    }
+}
+
 void Haploid::insert_coefs_gp(const size_t n) {
     URBG engine(std::random_device{}());
     for (size_t i=SELECTION_COEFS_GP_.size(); i<n; ++i) {
@@ -249,4 +377,15 @@ void Haploid::insert_coefs_gp(const size_t n) {
     }
 }
 
+void Haploid::insert_coefs_gp(const Haploid& x, URBG& engine) {
+    std::exponential_distribution<double> expo_dist(1.0 / param().MEAN_SELECTION_COEF);
+    std::bernoulli_distribution bern_functional(PROP_FUNCTIONAL_SITES_);
+    std::lock_guard<std::shared_timed_mutex> lock(MTX_);
+    for (const auto& p: x.sites_) {
+        if (SELECTION_COEFS_GP_.count(p.first)) continue;
+        SELECTION_COEFS_GP_.emplace(p.first, bern_functional(engine) ? expo_dist(engine) : 0.0);
+    }
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
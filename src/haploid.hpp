@@ -5,11 +5,13 @@
 #ifndef TEK_HAPLOID_HPP_
 #define TEK_HAPLOID_HPP_
 
+#include "length.hpp"
+#include "memory.hpp"
+
 #include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <vector>
-#include <set>
 #include <map>
 #include <unordered_map>
 #include <memory>
@@ -22,6 +24,10 @@ namespace wtl {class sfmt19937_64;}
 
 namespace tek {
 
+class TextBuffer;
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
 class Transposon;
 
 //! @brief Parameters for Haploid class
@@ -46,11 +52,22 @@ class Haploid {
     using URBG = wtl::sfmt19937_64;
     //! unsigned integer type for TE position
     using position_t = int32_t;
+    //! type of #SELECTION_COEFS_GP_
+    using coefs_gp_type = std::unordered_map<position_t, double,
+        std::hash<position_t>, std::equal_to<position_t>,
+        CountingAllocator<std::pair<const position_t, double>, Subsystem::coefs_gp>>;
+    //! type of #sites_
+    using sites_type = std::map<position_t, std::shared_ptr<Transposon>, std::less<position_t>,
+        CountingAllocator<std::pair<const position_t, std::shared_ptr<Transposon>>, Subsystem::sites>>;
 
     //! default constructor
     Haploid() = default;
-    //! constructor for recombination test
-    Haploid(size_t);
+    /*! @brief constructor for tests and benchmarks; TEs are taken from `transposons` in turn
+
+        Sites are random and not registered in #SELECTION_COEFS_GP_;
+        call insert_coefs_gp(const Haploid&, URBG&) before fitness() or transpose_mutate().
+    */
+    Haploid(size_t n, const std::vector<std::shared_ptr<Transposon>>& transposons = {});
     //! default copy constructor
     Haploid(const Haploid&) = default;
     //! default move constructor
@@ -60,7 +77,18 @@ class Haploid {
 
     //! return a Haploid object after recombination
     Haploid gametogenesis(const Haploid& other, URBG& engine) const;
+    //! gametogenesis() with the first chromosome `flg` and sorted `chiasmata` ending with the max position
+    Haploid gametogenesis(const Haploid& other, bool flg, const position_t* chiasmata) const;
     //! mutation process within an individual
+    void transpose_mutate(Haploid& other, URBG& engine) {
+        if (param().EXCISION_RATE > 0.0) {
+            transpose_mutate<true>(other, engine);
+        } else {
+            transpose_mutate<false>(other, engine);
+        }
+    }
+    //! transpose_mutate() without drawing excision if `Excision` is false
+    template <bool Excision>
     void transpose_mutate(Haploid& other, URBG& engine);
     //! introduce a hyperactivating mutation
     bool hyperactivate();
@@ -73,16 +101,30 @@ class Haploid {
                         \right) \\
         \end{split}\f]
     */
+    double fitness(const Haploid& other) const;
+    //! fitness() without per-species counting if `Speciation` is false and all TEs are in one species
+    template <bool Speciation>
     double fitness(const Haploid&) const;
 
-    //! return vector of Transposon summaries
-    std::vector<std::string> summarize() const;
+    //! write Transposon summaries as a JSON array of strings
+    TextBuffer& write_summary(TextBuffer&) const;
     //! write sequence with address as name
     std::ostream& write_fasta(std::ostream&) const;
+    //! write sites and indices of TEs in binary for Population::save()
+    std::ostream& write_binary(std::ostream&, const std::unordered_map<const Transposon*, uint32_t>& indices) const;
+    //! read binary written by write_binary()
+    static Haploid read_binary(std::istream&, const std::vector<std::shared_ptr<Transposon>>& transposons);
+    //! write #SELECTION_COEFS_GP_ in binary
+    static std::ostream& write_coefs_gp_binary(std::ostream&);
+    //! read binary written by write_coefs_gp_binary()
+    static void read_coefs_gp_binary(std::istream&);
     friend std::ostream& operator<<(std::ostream&, const Haploid&);
+    friend class GameteTable;
 
     //! shortcut of sites_.empty()
     bool empty() const {return sites_.empty();}
+    //! shortcut of sites_.size()
+    size_t size() const {return sites_.size();}
     //! shortcut of sites_.begin()
     auto begin() const {return sites_.begin();}
     //! shortcut of sites_.end()
@@ -92,10 +134,20 @@ class Haploid {
     static Haploid copy_founder();
     //! set static member variables
     static void initialize(size_t popsize, double theta, double rho);
+    //! discard values cached by distributions of this thread, so that offspring depend only on URBG
+    static void reset_thread_state();
     //! testing function to check distribution of #SELECTION_COEFS_GP_
     static void insert_coefs_gp(size_t);
+    //! testing function to draw #SELECTION_COEFS_GP_ of the sites of `x` not yet registered
+    static void insert_coefs_gp(const Haploid& x, URBG&);
+    //! sample sorted integers for recombination into a thread-local buffer
+    static const std::vector<position_t>& sample_chiasmata(URBG&);
     //! getter of #SELECTION_COEFS_GP_
-    static const std::unordered_map<position_t, double>& SELECTION_COEFS_GP() {return SELECTION_COEFS_GP_;}
+    static const coefs_gp_type& SELECTION_COEFS_GP() {return SELECTION_COEFS_GP_;}
+    //! replace #SELECTION_COEFS_GP_
+    static void SELECTION_COEFS_GP(coefs_gp_type&& x) {SELECTION_COEFS_GP_ = std::move(x);}
+    //! make this thread use `table` instead of #SELECTION_COEFS_GP_; nullptr to restore
+    static void use_coefs_gp(coefs_gp_type* table) noexcept;
 
     //! Set #PARAM_
     static void param(const param_type& p) {PARAM_ = p;}
@@ -109,8 +161,9 @@ class Haploid {
     //! default copy assignment operator (private)
     Haploid& operator=(const Haploid&) = default;
 
-    //! return TEs to be transposed
-    std::vector<std::shared_ptr<Transposon>> transpose(URBG&);
+    //! append TEs to be transposed
+    template <bool Excision>
+    void transpose(URBG&, std::vector<std::shared_ptr<Transposon>>*);
     //! make point mutation, indel, and speciation
     void mutate(URBG&);
     //! calculate genome position component of fitness
@@ -119,11 +172,15 @@ class Haploid {
         \f]
     */
     double prod_1_zs() const;
+    //! copy number component of fitness with all TEs in a single species
+    static double prod_1_xi_n_tau(uint_fast32_t copy_number);
+    //! copy number component of fitness from (species, copy number) pairs
+    static double prod_1_xi_n_tau(const std::vector<std::pair<uint_fast32_t, uint_fast32_t>>& counter);
 
-    //! insert an element into #SELECTION_COEFS_GP_ and return its key
+    //! insert an element into coefs_gp() and return its key
     static position_t SELECTION_COEFS_GP_emplace(URBG&);
-    //! sample integers for recombination
-    static std::set<position_t> sample_chiasmata(URBG&);
+    //! table set by use_coefs_gp() in this thread, or #SELECTION_COEFS_GP_
+    static coefs_gp_type& coefs_gp() noexcept;
 
     //! @addtogroup params
     //! @{
@@ -144,16 +201,22 @@ class Haploid {
     //! @} params
 
     //! \f$s_{GP}\f$ : coefficient of GP selection
-    static std::unordered_map<position_t, double> SELECTION_COEFS_GP_;
+    static coefs_gp_type SELECTION_COEFS_GP_;
     //! original TE with no mutation and complete activity
     static std::shared_ptr<Transposon> ORIGINAL_TE_;
     //! readers-writer lock for #SELECTION_COEFS_GP_
     static std::shared_timed_mutex MTX_;
 
     //! position => shptr to transposon
-    std::map<position_t, std::shared_ptr<Transposon>> sites_;
+    sites_type sites_;
 };
 
+template <> double Haploid::fitness<true>(const Haploid&) const;
+template <> double Haploid::fitness<false>(const Haploid&) const;
+
+inline double Haploid::fitness(const Haploid& other) const {return fitness<true>(other);}
+
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
 
 #endif /* TEK_HAPLOID_HPP_ */
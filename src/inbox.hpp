@@ -0,0 +1,67 @@
+/*! @file inbox.hpp
+    @brief Interface of Inbox class
+*/
+#pragma once
+#ifndef TEK_INBOX_HPP_
+#define TEK_INBOX_HPP_
+
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <utility>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+/*! @brief Lock-free multi-producer inbox drained by a single consumer
+
+    push() may be called from any thread without locks.
+    drain() must not overlap with push(), e.g., at generation boundaries.
+*/
+template <class T>
+class Inbox {
+  public:
+    //! constructor
+    Inbox() = default;
+    //! noncopyable
+    Inbox(const Inbox&) = delete;
+    //! delete remaining items
+    ~Inbox() {drain();}
+
+    //! add an item; lock-free
+    void push(T&& x) {
+        auto* node = new Node{std::move(x), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node,
+                   std::memory_order_release, std::memory_order_relaxed)) {;}
+    }
+
+    //! take all items in the order of push()
+    std::vector<T> drain() {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        std::vector<T> items;
+        while (node) {
+            items.push_back(std::move(node->value));
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(items.begin(), items.end());
+        return items;
+    }
+
+  private:
+    //! singly linked list
+    struct Node {
+        //! item
+        T value;
+        //! pushed before this
+        Node* next;
+    };
+    //! last pushed
+    std::atomic<Node*> head_{nullptr};
+};
+
+} // namespace tek
+
+#endif /* TEK_INBOX_HPP_ */
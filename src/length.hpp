@@ -0,0 +1,36 @@
+/*! @file length.hpp
+    @brief Sequence length of TE fixed at compile time
+*/
+#pragma once
+#ifndef TEK_LENGTH_HPP_
+#define TEK_LENGTH_HPP_
+
+#include <cstdint>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+#ifndef TEK_LENGTH
+  //! default \f$L\f$; the build compiles the core once per `TEK_LENGTHS`
+  #define TEK_LENGTH 300
+#endif
+
+#define TEK_CONCAT_IMPL_(x, y) x##y
+#define TEK_CONCAT_(x, y) TEK_CONCAT_IMPL_(x, y)
+/*! @brief Inline namespace of length-dependent classes, e.g., `tek::length300`
+
+    Each instantiation of the core can be linked into one executable
+    without conflicts of the static members.
+*/
+#define TEK_LENGTH_NAMESPACE TEK_CONCAT_(length, TEK_LENGTH)
+
+namespace tek {
+inline namespace TEK_LENGTH_NAMESPACE {
+
+//! \f$L\f$, sequence length of TE (bp)
+constexpr uint_fast32_t LENGTH = TEK_LENGTH;
+static_assert(LENGTH % 3u == 0u, "LENGTH must consist of codons");
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_LENGTH_HPP_ */
@@ -1,17 +1,62 @@
 /*! @file main.cpp
-    @brief Only defines tiny main()
+    @brief Only defines tiny main() to dispatch on `--length`
 */
-#include "program.hpp"
+#include "lengths.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
-#include <stdexcept>
+#include <limits>
+#include <string>
 
-//! Just instantiate and run Program
-int main(int argc, char* argv[]) {
-    try {
-        tek::Program program(argc, argv);
-        program.run();
-    } catch (const std::runtime_error& e) {
-        std::cerr << "\nruntime_error: " << e.what() << std::endl;
+//! @cond
+#define TEK_DECLARE_LAUNCH(n) \
+namespace tek {namespace length##n {int launch(int argc, char* argv[]);}}
+TEK_FOR_EACH_LENGTH(TEK_DECLARE_LAUNCH)
+//! @endcond
+
+namespace {
+
+//! value of `--length` that matches no compiled length
+constexpr unsigned long INVALID_LENGTH = std::numeric_limits<unsigned long>::max();
+
+//! decimal number in `str`, or #INVALID_LENGTH
+unsigned long to_length(const char* str) {
+    if (!std::isdigit(static_cast<unsigned char>(*str))) return INVALID_LENGTH;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long value = std::strtoul(str, &end, 10);
+    if (errno == ERANGE || *end != '\0') return INVALID_LENGTH;
+    return value;
+}
+
+//! value of `--length` if given, 0 if not, or #INVALID_LENGTH if malformed
+unsigned long parse_length(int argc, char* argv[]) {
+    const std::string key = "--length";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == key && i + 1 < argc) return to_length(argv[i + 1]);
+        if (arg.compare(0u, key.size() + 1u, key + "=") == 0) {
+            return to_length(argv[i] + key.size() + 1u);
+        }
     }
-    return 0;
+    return 0u;
+}
+
+}
+
+//! Dispatch to the instantiation of tek::launch() for the length
+int main(int argc, char* argv[]) {
+    const unsigned long length = parse_length(argc, argv);
+#define TEK_DISPATCH(n) \
+    if (length == 0u || length == n) return tek::length##n::launch(argc, argv);
+    TEK_FOR_EACH_LENGTH(TEK_DISPATCH)
+#undef TEK_DISPATCH
+    std::cerr << "--length must be one of:";
+#define TEK_PRINT(n) std::cerr << " " << n;
+    TEK_FOR_EACH_LENGTH(TEK_PRINT)
+#undef TEK_PRINT
+    std::cerr << std::endl;
+    return 1;
 }
@@ -0,0 +1,145 @@
+/*! @file memory.cpp
+    @brief Implementation of MemoryCounter and BlockPool classes
+*/
+#include "memory.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace tek {
+
+namespace {
+std::mutex& registry_mutex() {
+    static std::mutex mtx;
+    return mtx;
+}
+
+//! never destroyed, because static objects may deallocate after exit()
+template <class Slot>
+std::vector<Slot*>& registry() {
+    static auto* slots = new std::vector<Slot*>();
+    return *slots;
+}
+
+//! free batches of a size class shared among threads
+struct Depot {
+    //! lock for #head
+    std::mutex mtx;
+    //! first batch
+    void* head = nullptr;
+};
+
+//! never destroyed, because thread caches are released after exit()
+Depot* depots(size_t num_classes) {
+    static auto* x = new Depot[num_classes];
+    return x;
+}
+}
+
+void BlockPool::register_exit() noexcept {
+    thread_local ThreadExit thread_exit;
+    static_cast<void>(thread_exit);
+}
+
+void BlockPool::refill(const size_t i, Cache* cache) {
+    register_exit();
+    Depot& depot = depots(NUM_CLASSES)[i];
+    {
+        std::lock_guard<std::mutex> lock(depot.mtx);
+        if (depot.head) {
+            auto* batch = static_cast<Block*>(depot.head);
+            depot.head = batch->next_batch;
+            cache->head = batch;
+            size_t count = 0u;
+            for (Block* x = batch; x; x = x->next) ++count;
+            cache->count = count;
+            return;
+        }
+    }
+    constexpr size_t chunk_bytes = 1u << 16u;
+    const size_t size = (i + 1u) * ALIGN;
+    const size_t n = std::max<size_t>(chunk_bytes / size, 4u);
+    char* chunk = static_cast<char*>(::operator new(n * size));
+    Block* head = nullptr;
+    for (size_t j = n; j > 0u; --j) {
+        auto* block = reinterpret_cast<Block*>(chunk + (j - 1u) * size);
+        block->next = head;
+        head = block;
+    }
+    cache->head = head;
+    cache->count = n;
+}
+
+void BlockPool::release(const size_t i, Cache* cache, const bool all) noexcept {
+    Block* batch = cache->head;
+    Block* last = batch;
+    size_t count = 1u;
+    if (all) {
+        while (last->next) {
+            last = last->next;
+            ++count;
+        }
+    } else {
+        for (; count < BATCH; ++count) last = last->next;
+    }
+    cache->head = last->next;
+    cache->count -= count;
+    last->next = nullptr;
+    Depot& depot = depots(NUM_CLASSES)[i];
+    std::lock_guard<std::mutex> lock(depot.mtx);
+    batch->next_batch = static_cast<Block*>(depot.head);
+    depot.head = batch;
+}
+
+BlockPool::ThreadExit::~ThreadExit() {
+    auto& classes = local().classes;
+    for (size_t i = 0u; i < NUM_CLASSES; ++i) {
+        if (classes[i].head) release(i, &classes[i], true);
+    }
+}
+
+MemoryCounter::slot_type& MemoryCounter::new_slot() noexcept {
+    auto* slot = new slot_type();
+    for (auto& x: *slot) x.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry<slot_type>().push_back(slot);
+    return *slot;
+}
+
+int64_t MemoryCounter::sum(const unsigned int i) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    int64_t total = 0;
+    for (const auto* slot: registry<slot_type>()) {
+        total += (*slot)[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t MemoryCounter::blocks(const Subsystem s) {
+    return sum(2u * static_cast<unsigned int>(s));
+}
+
+int64_t MemoryCounter::bytes(const Subsystem s) {
+    return sum(2u * static_cast<unsigned int>(s) + 1u);
+}
+
+uint64_t MemoryCounter::resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0u, resident = 0u;
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    }
+    rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+}
+
+} // namespace tek
@@ -0,0 +1,211 @@
+/*! @file memory.hpp
+    @brief Interface of MemoryCounter, BlockPool, and CountingAllocator classes
+*/
+#pragma once
+#ifndef TEK_MEMORY_HPP_
+#define TEK_MEMORY_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <new>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+//! heap users counted by CountingAllocator
+enum class Subsystem: unsigned int {
+    transposons,
+    sites,
+    coefs_gp,
+    size_
+};
+
+/*! @brief Live blocks and bytes allocated per Subsystem
+
+    Each thread updates its own slot without read-modify-write,
+    and the slots are summed when read.
+    A block freed by another thread makes that slot negative,
+    which cancels out in the sum.
+*/
+class MemoryCounter {
+  public:
+    //! record allocation (positive) or deallocation (negative)
+    static void add(Subsystem s, int64_t blocks, int64_t bytes) noexcept {
+        auto& slot = local();
+        const auto i = 2u * static_cast<unsigned int>(s);
+        slot[i].store(slot[i].load(std::memory_order_relaxed) + blocks, std::memory_order_relaxed);
+        slot[i + 1u].store(slot[i + 1u].load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    }
+    //! number of live blocks
+    static int64_t blocks(Subsystem);
+    //! number of live bytes
+    static int64_t bytes(Subsystem);
+    //! resident set size of this process in bytes; peak RSS where unavailable
+    static uint64_t resident_bytes();
+
+  private:
+    //! blocks and bytes per Subsystem
+    using slot_type = std::array<std::atomic<int64_t>, 2u * static_cast<unsigned int>(Subsystem::size_)>;
+    //! sum over the slots of all threads
+    static int64_t sum(unsigned int i);
+    //! slot of this thread; registered on first use
+    static slot_type& local() noexcept {
+        thread_local slot_type& slot = new_slot();
+        return slot;
+    }
+    //! allocate and register a slot that outlives the thread
+    static slot_type& new_slot() noexcept;
+};
+
+/*! @brief Thread caches of fixed-size blocks for node-based containers
+
+    Blocks of each size class are carved from chunks that are never released.
+    A thread frees blocks into its own cache, which hands batches to a shared
+    depot when it grows too long and takes them back when it runs out.
+    Allocation and deallocation touch a lock only once per batch,
+    and a steady state of equal allocations and frees needs no operator new,
+    even if blocks are freed by threads other than those that allocated them.
+*/
+class BlockPool {
+  public:
+    //! max bytes of a pooled block; larger ones go to operator new
+    static constexpr size_t MAX_SIZE = 8192u;
+
+    //! allocate `size` bytes aligned for std::max_align_t
+    static void* allocate(size_t size) {
+        if (size > MAX_SIZE) return ::operator new(size);
+        const size_t i = index(size);
+        Cache& cache = local().classes[i];
+        if (!cache.head) refill(i, &cache);
+        Block* block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+    //! return a block allocated with the same `size`
+    static void deallocate(void* p, size_t size) noexcept {
+        if (size > MAX_SIZE) {
+            ::operator delete(p);
+            return;
+        }
+        const size_t i = index(size);
+        Cache& cache = local().classes[i];
+        // a thread that only frees must also return its cache at exit
+        if (!cache.head) register_exit();
+        auto* block = static_cast<Block*>(p);
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2u * BATCH) release(i, &cache);
+    }
+
+  private:
+    //! alignment and granularity of size classes
+    static constexpr size_t ALIGN = alignof(std::max_align_t);
+    //! number of blocks moved between a cache and the depot at once
+    static constexpr size_t BATCH = 64u;
+    //! number of size classes
+    static constexpr size_t NUM_CLASSES = MAX_SIZE / ALIGN;
+    //! free block
+    struct Block {
+        //! next block in the same list
+        Block* next;
+        //! next batch in the depot
+        Block* next_batch;
+    };
+    static_assert(sizeof(Block) <= ALIGN, "");
+    //! free list of a thread
+    struct Cache {
+        //! first free block
+        Block* head = nullptr;
+        //! length of the list
+        size_t count = 0u;
+    };
+    //! free lists of all size classes; trivially destructible
+    struct Caches {
+        //! indexed by size class
+        std::array<Cache, NUM_CLASSES> classes;
+    };
+    //! return the caches of this thread to the depot at thread exit
+    struct ThreadExit {
+        //! release all blocks
+        ~ThreadExit();
+    };
+    //! size class of `size` bytes
+    static size_t index(size_t size) noexcept {
+        return (size + ALIGN - 1u) / ALIGN - (size > 0u ? 1u : 0u);
+    }
+    //! caches of this thread
+    static Caches& local() noexcept {
+        thread_local Caches caches;
+        return caches;
+    }
+    //! take a batch from the depot or carve a new chunk; register ThreadExit
+    static void refill(size_t i, Cache*);
+    //! construct ThreadExit of this thread if not yet
+    static void register_exit() noexcept;
+    //! move a batch to the depot; all blocks if `all`
+    static void release(size_t i, Cache*, bool all = false) noexcept;
+};
+
+/*! @brief std::allocator that reports to MemoryCounter
+
+    Single objects, such as container nodes and shared_ptr control blocks,
+    are taken from BlockPool.
+*/
+template <class T, Subsystem S>
+class CountingAllocator {
+  public:
+    //! required by Allocator
+    using value_type = T;
+    //! required for rebinding with a non-type template parameter
+    template <class U> struct rebind {using other = CountingAllocator<U, S>;};
+
+    CountingAllocator() noexcept = default;
+    //! converting constructor
+    template <class U>
+    CountingAllocator(const CountingAllocator<U, S>&) noexcept {}
+
+    //! allocate and count
+    T* allocate(size_t n) {
+        T* p = is_pooled(n) ? static_cast<T*>(BlockPool::allocate(sizeof(T)))
+                            : std::allocator<T>().allocate(n);
+        MemoryCounter::add(S, 1, static_cast<int64_t>(n * sizeof(T)));
+        return p;
+    }
+    //! deallocate and count
+    void deallocate(T* p, size_t n) noexcept {
+        MemoryCounter::add(S, -1, -static_cast<int64_t>(n * sizeof(T)));
+        if (is_pooled(n)) {
+            BlockPool::deallocate(p, sizeof(T));
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    //! stateless
+    template <class U>
+    bool operator==(const CountingAllocator<U, S>&) const noexcept {return true;}
+    //! stateless
+    template <class U>
+    bool operator!=(const CountingAllocator<U, S>&) const noexcept {return false;}
+
+  private:
+    //! true if allocated from BlockPool
+    static constexpr bool is_pooled(size_t n) noexcept {
+        return n == 1u && alignof(T) <= alignof(std::max_align_t);
+    }
+};
+
+//! std::make_shared() counted as the Subsystem
+template <Subsystem S, class T, class... Args> inline
+std::shared_ptr<T> make_counted(Args&&... args) {
+    return std::allocate_shared<T>(CountingAllocator<T, S>(), std::forward<Args>(args)...);
+}
+
+} // namespace tek
+
+#endif /* TEK_MEMORY_HPP_ */
@@ -0,0 +1,195 @@
+/*! @file metrics.cpp
+    @brief Implementation of Metrics class
+*/
+#include "metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tek {
+
+namespace {
+constexpr uint64_t MAGIC = 0x31504f544b4554ull; // "TEKTOP1"
+constexpr const char* PREFIX = "tek2.";
+constexpr size_t DIRECTORY_SIZE = 256u;
+
+//! index of Metrics::Page::fields in the order of MetricsValues
+enum Field: unsigned int {
+    PID, START_NS, UPDATE_NS, GENERATION, MAX_GENERATIONS,
+    NUM_TRANSPOSONS, NUM_SPECIES, RESIDENT_BYTES, STATE,
+    GENERATIONS_PER_SEC, MEAN_FITNESS, ACCEPTANCE_RATE,
+    NUM_FIELDS
+};
+
+uint64_t now_ns() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+uint64_t to_bits(double x) noexcept {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+double from_bits(uint64_t bits) noexcept {
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+}
+
+//! fields are relaxed atomics ordered by #sequence
+struct Metrics::Page {
+    //! #MAGIC after initialization
+    std::atomic<uint64_t> magic;
+    //! odd while being written
+    std::atomic<uint64_t> sequence;
+    //! MetricsValues in order; doubles are stored as bits
+    std::atomic<uint64_t> fields[NUM_FIELDS];
+    //! written once before #magic
+    char directory[DIRECTORY_SIZE];
+};
+
+Metrics* Metrics::CURRENT_ = nullptr;
+
+Metrics::Metrics()
+: name_("/" + std::string(PREFIX) + std::to_string(::getpid())) {
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("shm_open() failed: " + name_);
+    if (::ftruncate(fd, sizeof(Page)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("ftruncate() failed: " + name_);
+    }
+    void* addr = ::mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("mmap() failed: " + name_);
+    }
+    page_ = new (addr) Page();
+    page_->sequence.store(0u, std::memory_order_relaxed);
+    for (auto& x: page_->fields) x.store(0u, std::memory_order_relaxed);
+    const uint64_t start = now_ns();
+    page_->fields[PID].store(static_cast<uint64_t>(::getpid()), std::memory_order_relaxed);
+    page_->fields[START_NS].store(start, std::memory_order_relaxed);
+    page_->fields[UPDATE_NS].store(start, std::memory_order_relaxed);
+    if (!::getcwd(page_->directory, DIRECTORY_SIZE)) page_->directory[0] = '\0';
+    page_->magic.store(MAGIC, std::memory_order_release);
+    CURRENT_ = this;
+}
+
+Metrics::~Metrics() {
+    if (CURRENT_ == this) CURRENT_ = nullptr;
+    ::munmap(page_, sizeof(Page));
+    ::shm_unlink(name_.c_str());
+}
+
+void Metrics::publish(MetricsValues values) {
+    if (!CURRENT_) return;
+    Page& page = *CURRENT_->page_;
+    auto& f = page.fields;
+    // only this thread writes the page
+    const uint64_t previous_generation = f[GENERATION].load(std::memory_order_relaxed);
+    const uint64_t previous_ns = f[UPDATE_NS].load(std::memory_order_relaxed);
+    values.pid = f[PID].load(std::memory_order_relaxed);
+    values.start_ns = f[START_NS].load(std::memory_order_relaxed);
+    values.update_ns = now_ns();
+    values.generations_per_sec = from_bits(f[GENERATIONS_PER_SEC].load(std::memory_order_relaxed));
+    if (values.generation > previous_generation && values.update_ns > previous_ns) {
+        constexpr double weight = 0.1;
+        const double rate = 1e9 * (values.generation - previous_generation) / (values.update_ns - previous_ns);
+        values.generations_per_sec = (values.generations_per_sec > 0.0)
+          ? (1.0 - weight) * values.generations_per_sec + weight * rate
+          : rate;
+    }
+    const uint64_t seq = page.sequence.load(std::memory_order_relaxed);
+    page.sequence.store(seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    f[UPDATE_NS].store(values.update_ns, std::memory_order_relaxed);
+    f[GENERATION].store(values.generation, std::memory_order_relaxed);
+    f[MAX_GENERATIONS].store(values.max_generations, std::memory_order_relaxed);
+    f[NUM_TRANSPOSONS].store(values.num_transposons, std::memory_order_relaxed);
+    f[NUM_SPECIES].store(values.num_species, std::memory_order_relaxed);
+    f[RESIDENT_BYTES].store(values.resident_bytes, std::memory_order_relaxed);
+    f[STATE].store(static_cast<uint64_t>(values.state), std::memory_order_relaxed);
+    f[GENERATIONS_PER_SEC].store(to_bits(values.generations_per_sec), std::memory_order_relaxed);
+    f[MEAN_FITNESS].store(to_bits(values.mean_fitness), std::memory_order_relaxed);
+    f[ACCEPTANCE_RATE].store(to_bits(values.acceptance_rate), std::memory_order_relaxed);
+    page.sequence.store(seq + 2u, std::memory_order_release);
+}
+
+std::vector<std::string> Metrics::list() {
+    std::vector<std::string> names;
+    DIR* dir = ::opendir("/dev/shm");
+    if (!dir) return names;
+    const size_t prefix_size = std::strlen(PREFIX);
+    while (const dirent* entry = ::readdir(dir)) {
+        if (std::strncmp(entry->d_name, PREFIX, prefix_size) == 0) {
+            names.push_back(std::string("/") + entry->d_name);
+        }
+    }
+    ::closedir(dir);
+    return names;
+}
+
+bool Metrics::read(const std::string& name, MetricsValues* values) {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Page)) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = ::mmap(nullptr, sizeof(Page), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+    const Page& page = *static_cast<const Page*>(addr);
+    bool good = (page.magic.load(std::memory_order_acquire) == MAGIC);
+    uint64_t fields[NUM_FIELDS];
+    for (unsigned int attempt = 0u; good; ++attempt) {
+        if (attempt > 10000u) {
+            good = false;
+            break;
+        }
+        const uint64_t before = page.sequence.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+        for (unsigned int i = 0u; i < NUM_FIELDS; ++i) {
+            fields[i] = page.fields[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page.sequence.load(std::memory_order_relaxed) == before) break;
+    }
+    if (good) {
+        values->pid = fields[PID];
+        values->start_ns = fields[START_NS];
+        values->update_ns = fields[UPDATE_NS];
+        values->generation = fields[GENERATION];
+        values->max_generations = fields[MAX_GENERATIONS];
+        values->num_transposons = fields[NUM_TRANSPOSONS];
+        values->num_species = fields[NUM_SPECIES];
+        values->resident_bytes = fields[RESIDENT_BYTES];
+        values->state = static_cast<RunState>(fields[STATE]);
+        values->generations_per_sec = from_bits(fields[GENERATIONS_PER_SEC]);
+        values->mean_fitness = from_bits(fields[MEAN_FITNESS]);
+        values->acceptance_rate = from_bits(fields[ACCEPTANCE_RATE]);
+        values->directory.assign(page.directory, ::strnlen(page.directory, DIRECTORY_SIZE));
+    }
+    ::munmap(addr, sizeof(Page));
+    return good;
+}
+
+void Metrics::remove(const std::string& name) {
+    ::shm_unlink(name.c_str());
+}
+
+} // namespace tek
@@ -0,0 +1,94 @@
+/*! @file metrics.hpp
+    @brief Interface of Metrics class
+*/
+#pragma once
+#ifndef TEK_METRICS_HPP_
+#define TEK_METRICS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+//! run state published by Metrics
+enum class RunState: uint64_t {
+    running,
+    finished,
+    extinct
+};
+
+//! @brief Values published by a running process
+struct MetricsValues {
+    //! process ID
+    uint64_t pid = 0u;
+    //! time when the page was created (ns since epoch)
+    uint64_t start_ns = 0u;
+    //! time of the last publish() (ns since epoch)
+    uint64_t update_ns = 0u;
+    //! current generation
+    uint64_t generation = 0u;
+    //! generations to simulate
+    uint64_t max_generations = 0u;
+    //! number of TEs in the population
+    uint64_t num_transposons = 0u;
+    //! number of species in the current generation
+    uint64_t num_species = 0u;
+    //! resident set size in bytes
+    uint64_t resident_bytes = 0u;
+    //! RunState
+    RunState state = RunState::running;
+    //! exponential moving average of generations per second
+    double generations_per_sec = 0.0;
+    //! mean fitness of the accepted offspring
+    double mean_fitness = 0.0;
+    //! acceptances / attempts in the last generation
+    double acceptance_rate = 0.0;
+    //! working directory of the process
+    std::string directory;
+};
+
+/*! @brief Live metrics in a POSIX shared-memory page `/tek2.<pid>`
+
+    The writer updates the page under a sequence lock without blocking,
+    and readers retry while a write is in progress.
+    An instance publishes for the process while it exists;
+    static publish() is a no-op otherwise.
+*/
+class Metrics {
+  public:
+    //! create and map the page of this process
+    Metrics();
+    //! unmap and remove the page
+    ~Metrics();
+    //! noncopyable
+    Metrics(const Metrics&) = delete;
+
+    //! update the page of this process if an instance exists
+    static void publish(MetricsValues values);
+    //! true if an instance exists
+    static bool enabled() noexcept {return CURRENT_ != nullptr;}
+
+    //! names of the pages of all processes
+    static std::vector<std::string> list();
+    //! read a consistent copy of a page; false if it is invalid
+    static bool read(const std::string& name, MetricsValues* values);
+    //! remove a page left by a dead process
+    static void remove(const std::string& name);
+
+  private:
+    //! layout in shared memory
+    struct Page;
+    //! instance publishing now
+    static Metrics* CURRENT_;
+    //! mapped page
+    Page* page_ = nullptr;
+    //! name passed to shm_open()
+    std::string name_;
+};
+
+} // namespace tek
+
+#endif /* TEK_METRICS_HPP_ */
@@ -0,0 +1,111 @@
+/*! @file perf.cpp
+    @brief Implementation of PerfCounters class
+*/
+#include "perf.hpp"
+
+#include <atomic>
+
+#ifdef __linux__
+  #include <cstring>
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace tek {
+
+namespace {
+constexpr unsigned int NUM_COUNTERS = static_cast<unsigned int>(Counter::size_);
+
+constexpr const char* COUNTER_NAMES[] = {
+    "cycles",
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "branch_misses",
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == NUM_COUNTERS, "");
+
+std::atomic<bool> AVAILABLE[NUM_COUNTERS] = {};
+
+#ifdef __linux__
+//! (type, config) of each Counter
+constexpr uint64_t EVENTS[][2] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                         | (PERF_COUNT_HW_CACHE_OP_READ << 8u)
+                         | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+static_assert(sizeof(EVENTS) / sizeof(EVENTS[0]) == NUM_COUNTERS, "");
+
+//! counters of a thread in one group to be read at once
+class Group {
+  public:
+    Group() noexcept {
+        for (unsigned int i=0u; i<NUM_COUNTERS; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = static_cast<uint32_t>(EVENTS[i][0]);
+            attr.config = EVENTS[i][1];
+            attr.disabled = (leader_ < 0) ? 1u : 0u;
+            attr.exclude_kernel = 1u;
+            attr.exclude_hv = 1u;
+            attr.read_format = PERF_FORMAT_GROUP;
+            const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0ul);
+            if (fd < 0) continue;
+            if (leader_ < 0) leader_ = static_cast<int>(fd);
+            fds_[size_] = static_cast<int>(fd);
+            counters_[size_++] = i;
+            AVAILABLE[i].store(true, std::memory_order_relaxed);
+        }
+        if (leader_ >= 0) {
+            ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+    ~Group() {
+        for (unsigned int i=0u; i<size_; ++i) ::close(fds_[i]);
+    }
+    void read(PerfCounters::value_type* values) const noexcept {
+        values->fill(0u);
+        if (leader_ < 0) return;
+        // {nr, values[nr]} with PERF_FORMAT_GROUP
+        uint64_t buffer[NUM_COUNTERS + 1u];
+        if (::read(leader_, buffer, sizeof(buffer)) <= 0) return;
+        for (unsigned int i=0u; i<size_ && i<buffer[0]; ++i) {
+            (*values)[counters_[i]] = buffer[i + 1u];
+        }
+    }
+  private:
+    int leader_ = -1;
+    unsigned int size_ = 0u;
+    int fds_[NUM_COUNTERS] = {};
+    unsigned int counters_[NUM_COUNTERS] = {};
+};
+#endif
+}
+
+bool PerfCounters::ENABLED_ = false;
+
+void PerfCounters::read(value_type* values) noexcept {
+#ifdef __linux__
+    thread_local Group group;
+    group.read(values);
+#else
+    values->fill(0u);
+#endif
+}
+
+bool PerfCounters::available(const Counter counter) noexcept {
+    return AVAILABLE[static_cast<unsigned int>(counter)].load(std::memory_order_relaxed);
+}
+
+const char* PerfCounters::name(const Counter counter) noexcept {
+    return COUNTER_NAMES[static_cast<unsigned int>(counter)];
+}
+
+} // namespace tek
@@ -0,0 +1,56 @@
+/*! @file perf.hpp
+    @brief Interface of PerfCounters class
+*/
+#pragma once
+#ifndef TEK_PERF_HPP_
+#define TEK_PERF_HPP_
+
+#include <cstdint>
+#include <array>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+//! hardware events read by PerfCounters
+enum class Counter: unsigned int {
+    cycles,
+    instructions,
+    l1d_miss,
+    llc_miss,
+    branch_miss,
+    size_
+};
+
+/*! @brief Hardware performance counters of the calling thread
+
+    Counters are opened with Linux perf_event_open(2)
+    at the first read() in each thread, and closed at thread exit.
+    Counters that cannot be opened read as zero;
+    available() tells whether a counter has been opened in any thread.
+*/
+class PerfCounters {
+  public:
+    //! values indexed by Counter
+    using value_type = std::array<uint64_t, static_cast<unsigned int>(Counter::size_)>;
+
+    //! current values of this thread; zeros if unavailable
+    static void read(value_type* values) noexcept;
+    //! true if the counter has been opened in any thread
+    static bool available(Counter) noexcept;
+    //! column name
+    static const char* name(Counter) noexcept;
+
+    //! run-time switch
+    static void enabled(bool x) noexcept {ENABLED_ = x;}
+    //! run-time switch
+    static bool enabled() noexcept {return ENABLED_;}
+
+  private:
+    //! run-time switch
+    static bool ENABLED_;
+};
+
+} // namespace tek
+
+#endif /* TEK_PERF_HPP_ */
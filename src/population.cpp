@@ -3,25 +3,52 @@
 */
 #include "population.hpp"
 #include "haploid.hpp"
+#include "proposal.hpp"
 #include "transposon.hpp"
+#include "statistics.hpp"
+#include "diversity.hpp"
+#include "sitefreq.hpp"
+#include "series.hpp"
+#include "recorder.hpp"
+#include "bgzf.hpp"
+#include "column.hpp"
+#include "textbuf.hpp"
+#include "profile.hpp"
+#include "inbox.hpp"
+#include "binary.hpp"
+#include "memory.hpp"
+#include "genealogy.hpp"
+#include "metrics.hpp"
 
 #include <wtl/debug.hpp>
 #include <wtl/iostr.hpp>
-#include <wtl/zlib.hpp>
 #include <wtl/concurrent.hpp>
 #include <wtl/random.hpp>
 #include <sfmt.hpp>
-#include <clippson/json.hpp>
 
+#include <fstream>
+#include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <numeric>
 
 namespace tek {
 
+inline namespace TEK_LENGTH_NAMESPACE {
+
 namespace {
+inline wtl::ThreadPool& thread_pool() {
+    static wtl::ThreadPool pool(Population::param().CONCURRENCY);
+    return pool;
+}
+
+//! set by once_in_a_run() at the time until an offspring is hyperactivated
+bool is_the_time = false;
+
 inline void once_in_a_run(size_t now, size_t then, Haploid* hapl = nullptr) {
-    static bool is_the_time = false;
     static unsigned failures = 0u;
     if (hapl) {
         if (is_the_time) {
@@ -35,6 +62,177 @@ inline void once_in_a_run(size_t now, size_t then, Haploid* hapl = nullptr) {
         is_the_time = true;
     }
 }
+
+//! fill `nextgen` with offspring of `gametes` in this thread and return max fitness
+double step_serial(const std::vector<Haploid>& gametes, std::vector<Haploid>* nextgen,
+                   Haploid::URBG& engine, const double previous_max_fitness) {
+    const size_t num_gametes = gametes.size();
+    std::uniform_int_distribution<size_t> dist_idx(0u, num_gametes / 2u - 1u);
+    double max_fitness = 0.0;
+    nextgen->clear();
+    nextgen->reserve(num_gametes);
+    while (nextgen->size() < num_gametes) {
+        const size_t mother_idx = dist_idx(engine);
+        size_t father_idx = 0u;
+        while ((father_idx = dist_idx(engine)) == mother_idx) {;}
+        auto egg   = gametes[2u * mother_idx].gametogenesis(gametes[2u * mother_idx + 1u], engine);
+        auto sperm = gametes[2u * father_idx].gametogenesis(gametes[2u * father_idx + 1u], engine);
+        const double fitness = egg.fitness(sperm);
+        if (fitness < wtl::generate_canonical(engine) * previous_max_fitness) continue;
+        egg.transpose_mutate(sperm, engine);
+        max_fitness = std::max(max_fitness, fitness);
+        nextgen->push_back(std::move(egg));
+        nextgen->push_back(std::move(sperm));
+    }
+    return max_fitness;
+}
+
+//! offspring sent to another deme by Population::step_demes()
+struct Migrant {
+    //! gamete from the mother
+    Haploid egg;
+    //! gamete from the father
+    Haploid sperm;
+    //! fitness of the zygote
+    double fitness;
+};
+
+//! total number of TE copies
+size_t count_copies(const std::vector<Haploid>& gametes) {
+    size_t n = 0u;
+    for (const auto& x: gametes) n += x.size();
+    return n;
+}
+
+//! make Haploid use a table of selection coefficients in this thread while alive
+class ScopedCoefsGp {
+  public:
+    //! use `table`
+    explicit ScopedCoefsGp(Haploid::coefs_gp_type* table) noexcept {Haploid::use_coefs_gp(table);}
+    //! restore the shared table
+    ~ScopedCoefsGp() {Haploid::use_coefs_gp(nullptr);}
+    //! noncopyable
+    ScopedCoefsGp(const ScopedCoefsGp&) = delete;
+};
+
+//! seed of the k-th attempt derived from `base`
+uint64_t attempt_seed(const uint64_t base, const size_t k) {
+    std::seed_seq seq{static_cast<uint32_t>(base), static_cast<uint32_t>(base >> 32u),
+                      static_cast<uint32_t>(k), static_cast<uint32_t>(static_cast<uint64_t>(k) >> 32u)};
+    uint32_t words[2];
+    seq.generate(words, words + 2);
+    return (static_cast<uint64_t>(words[1]) << 32u) | words[0];
+}
+
+constexpr char SNAPSHOT_MAGIC[] = "TEKSNAP1";
+constexpr size_t SNAPSHOT_MAGIC_SIZE = sizeof(SNAPSHOT_MAGIC) - 1u;
+
+/*! @brief wrap a Recorder job to time it as a row of generation `t`
+
+    The rows are written to profile_writers.tsv.gz on the Recorder thread
+    and added to `total`, instead of the profile.tsv row of whichever
+    generation is running when the job finishes.
+*/
+template <class Job>
+inline Recorder::job_type timed(const Phase phase, const size_t t, std::shared_ptr<Profile> total, Job&& job) {
+    return [phase, t, total, job = std::forward<Job>(job)](Recorder& rec) mutable {
+        Stopwatch stopwatch;
+        job(rec);
+        stopwatch.lap(phase);
+        if (!Profile::enabled()) return;
+        Profile row;
+        std::swap(row, Profile::local());
+        row.write(rec.stream("profile_writers.tsv.gz", Profile::header()), t);
+        *total += row;
+    };
+}
+
+//! copy of sampled TEs to be written on the Recorder thread
+class FastaSample {
+  public:
+    FastaSample(const std::vector<Haploid>& gametes, size_t num_individuals) {
+        num_individuals = std::min(num_individuals, gametes.size() / 2u);
+        individuals_.resize(num_individuals);
+        std::unordered_map<const Transposon*, size_t> indices;
+        // copy numbers by index in alleles_; reset to zero after each individual
+        std::vector<unsigned int> copies;
+        for (size_t i=0u; i<num_individuals; ++i) {
+            auto& individual = individuals_[i];
+            for (size_t j: {0u, 1u}) {
+                for (const auto& p: gametes[2u * i + j]) {
+                    auto it = indices.emplace(p.second.get(), alleles_.size()).first;
+                    if (it->second == alleles_.size()) {
+                        alleles_.push_back(*p.second);
+                        labels_.push_back(p.second.get());
+                        copies.push_back(0u);
+                    }
+                    if (copies[it->second]++ == 0u) {
+                        individual.emplace_back(it->second, 0u);
+                    }
+                }
+            }
+            for (auto& p: individual) {
+                p.second = copies[p.first];
+                copies[p.first] = 0u;
+            }
+        }
+    }
+
+    std::ostream& write(std::ostream& ost) const {
+        for (size_t i=0u; i<individuals_.size(); ++i) {
+            for (const auto& p: individuals_[i]) {
+                const auto& te = alleles_[p.first];
+                te.write_metadata(ost << ">individual=" << i << " ", labels_[p.first]);
+                ost << " copy_number=" << p.second << "\n";
+                te.write_sequence(ost) << "\n";
+            }
+        }
+        return ost;
+    }
+
+    //! write each unique allele once, and copy numbers in individuals
+    void write_alleles(std::ostream& fasta, std::ostream& table) const {
+        struct Hash {
+            size_t operator()(const Transposon* x) const noexcept {return x->hash();}
+        };
+        struct Equal {
+            bool operator()(const Transposon* x, const Transposon* y) const noexcept {return *x == *y;}
+        };
+        std::unordered_map<const Transposon*, size_t, Hash, Equal> ids;
+        std::vector<size_t> allele_ids(alleles_.size());
+        char line[LENGTH + 1u];
+        line[LENGTH] = '\n';
+        for (size_t k=0u; k<alleles_.size(); ++k) {
+            const auto& te = alleles_[k];
+            const auto it = ids.emplace(&te, ids.size()).first;
+            allele_ids[k] = it->second;
+            if (it->first == &te) {
+                te.write_properties(fasta << ">allele=" << it->second << " ") << "\n";
+                fasta.write(line, te.encode_sequence(line) - line + 1);
+            }
+        }
+        table << "individual\tallele\tcopy_number\n";
+        for (size_t i=0u; i<individuals_.size(); ++i) {
+            std::map<size_t, unsigned int> counter;
+            for (const auto& p: individuals_[i]) {
+                counter[allele_ids[p.first]] += p.second;
+            }
+            for (const auto& p: counter) {
+                table << i << "\t" << p.first << "\t" << p.second << "\n";
+            }
+        }
+    }
+
+    //! write new alleles and copy numbers relative to the last record
+    void write_delta(AlleleSeries* series, std::ostream& alleles, std::ostream& copies, size_t time) const {
+        series->write(alleles, copies, time, alleles_, individuals_);
+    }
+
+  private:
+    std::vector<Transposon> alleles_;
+    std::vector<const Transposon*> labels_;
+    std::vector<std::vector<std::pair<size_t, unsigned int>>> individuals_;
+};
 }
 
 Population::param_type Population::PARAM_;
@@ -47,71 +245,411 @@ Population::Population(const size_t size, const size_t num_founders) {HERE;
         gametes_.push_back(Haploid::copy_founder());
     }
     gametes_.resize(size * 2u);
+    recount();
+}
+
+Population::Population(std::istream& ist) {HERE;
+    std::array<char, SNAPSHOT_MAGIC_SIZE> magic;
+    if (!ist.read(magic.data(), magic.size()) || std::memcmp(magic.data(), SNAPSHOT_MAGIC, magic.size())) {
+        throw std::runtime_error("not a tek2 snapshot");
+    }
+    if (read_pod<uint32_t>(ist) != LENGTH) {
+        throw std::runtime_error("snapshot of a different LENGTH");
+    }
+    const auto num_gametes = read_pod<uint64_t>(ist);
+    Haploid::initialize(num_gametes / 2u, THETA, RHO);
+    Haploid::read_coefs_gp_binary(ist);
+    Transposon::read_species_binary(ist);
+    std::vector<std::shared_ptr<Transposon>> transposons(read_pod<uint64_t>(ist));
+    for (auto& x: transposons) {
+        x = make_counted<Subsystem::transposons, Transposon>(Transposon::read_binary(ist));
+    }
+    gametes_.reserve(num_gametes);
+    for (uint64_t i=0u; i<num_gametes; ++i) {
+        gametes_.push_back(Haploid::read_binary(ist, transposons));
+    }
+    recount();
+}
+
+Population::Population(std::vector<Haploid>&& gametes)
+: gametes_(std::move(gametes)) {HERE;
+    recount();
 }
 
 Population::~Population() = default;
 
-bool Population::evolve(const size_t max_generations, const size_t record_interval, const Recording flags, const size_t t_hyperactivate) {HERE;
+std::ostream& Population::save(std::ostream& ost) const {HERE;
+    std::unordered_map<const Transposon*, uint32_t> indices;
+    std::vector<const Transposon*> transposons;
+    for (const auto& x: gametes_) {
+        for (const auto& p: x) {
+            if (indices.emplace(p.second.get(), static_cast<uint32_t>(transposons.size())).second) {
+                transposons.push_back(p.second.get());
+            }
+        }
+    }
+    ost.write(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    write_pod(ost, static_cast<uint32_t>(LENGTH));
+    write_pod(ost, static_cast<uint64_t>(gametes_.size()));
+    Haploid::write_coefs_gp_binary(ost);
+    Transposon::write_species_binary(ost);
+    write_pod(ost, static_cast<uint64_t>(transposons.size()));
+    for (const auto* te: transposons) {
+        te->write_binary(ost);
+    }
+    for (const auto& x: gametes_) {
+        x.write_binary(ost, indices);
+    }
+    return ost;
+}
+
+bool Population::evolve(const size_t max_generations, const size_t record_interval, const Recording flags,
+                        const size_t t_hyperactivate, const size_t first_generation) {HERE;
     constexpr double margin = 0.1;
     double max_fitness = 1.0;
-    for (size_t t=1; t<=max_generations; ++t) {
-        once_in_a_run(t, t_hyperactivate);
+    Recorder recorder(4u, param().CONCURRENCY);
+    auto series = std::make_shared<AlleleSeries>();
+    bool over_budget = false;
+    const bool genealogy = static_cast<bool>(flags & Recording::genealogy);
+    Genealogy::clear();
+    Genealogy::enabled(genealogy);
+    std::ofstream profile_ofs;
+    Profile profile_total;
+    // written only by Recorder jobs until recorder.close()
+    auto profile_writers = std::make_shared<Profile>();
+    MetricsValues metrics;
+    metrics.max_generations = max_generations;
+    if (Profile::enabled()) {
+        profile_ofs = wtl::make_ofs("profile.tsv");
+        Profile::write_header(profile_ofs);
+        // work before the run, e.g., establishment, as the row of the preceding generation
+        Profile::merge();
+        const Profile row = Profile::take();
+        if (!row.empty()) row.write(profile_ofs, first_generation - 1u);
+        profile_total += row;
+    }
+    //! close recorder, write work after the last row, and write hardware counters of the whole run
+    auto close_recorder = [&recorder, &profile_ofs, &profile_total, profile_writers](const size_t t) {
+        recorder.close();
+        if (!Profile::enabled()) return;
+        Profile::merge();
+        const Profile row = Profile::take();
+        if (!row.empty()) row.write(profile_ofs, t);
+        profile_total += row;
+        profile_total += *profile_writers;
+        if (!PerfCounters::enabled()) return;
+        auto ofs = wtl::make_ofs("perf.tsv");
+        profile_total.write_counters(ofs);
+    };
+    for (size_t t=first_generation; t<=max_generations; ++t) {
+        hyperactivate(t, t_hyperactivate);
+        Genealogy::generation(static_cast<uint32_t>(t));
         bool is_recording = ((t % record_interval) == 0u);
-        const auto fitness_record = step(max_fitness);
-        max_fitness = *std::max_element(fitness_record.begin(), fitness_record.end());
-        max_fitness = std::min(max_fitness + margin, 1.0);
+        const bool fitness_rows = is_recording && static_cast<bool>(flags & Recording::fitness);
+        std::vector<double> fitness_record;
+        const auto sketch = step(max_fitness, fitness_rows ? &fitness_record : nullptr);
+        max_fitness = std::min(sketch.max() + margin, 1.0);
+        const bool inactive = param().STOP_INACTIVE && counts_.active == 0u;
+        if (Metrics::enabled()) {
+            metrics.generation = t;
+            metrics.num_transposons = counts_.transposons;
+            metrics.num_species = counts_.num_species();
+            metrics.mean_fitness = sketch.mean();
+            metrics.acceptance_rate = static_cast<double>(sketch.count()) / num_attempts_;
+        }
+        if (is_recording) {
+            recorder.push([t](Recorder& rec) {rec.mark(t);});
+        }
+        if (static_cast<bool>(flags & Recording::sketch)) {
+            std::ostringstream row;
+            sketch.write(row, t);
+            recorder.push(timed(Phase::write_sketch, t, profile_writers, [row = row.str()](Recorder& rec) {
+                rec.stream("fitness_sketch.tsv.gz", FitnessSketch::header()) << row;
+            }));
+        }
+        bool extinct = false;
         if (is_recording) {
             std::cerr << "*" << std::flush;
-            if (Transposon::can_speciate()) {
-                eval_species_distance();
+            Stopwatch stopwatch;
+            if (genealogy) {
+                Genealogy::simplify(gametes_);
+                stopwatch.lap(Phase::simplify);
             }
+            auto stats = std::make_shared<Statistics>(census(&stopwatch));
+            extinct = (stats->num_transposons() == 0u);
+            const bool columnar = static_cast<bool>(flags & Recording::columnar);
             if (static_cast<bool>(flags & Recording::activity)) {
-                auto ioflag = (t > record_interval) ? std::ios::app : std::ios::out;
-                wtl::zlib::ofstream ozf("activity.tsv.gz", ioflag);
-                write_activity(ozf, t, t == record_interval);
+                recorder.push(timed(Phase::write_activity, t, profile_writers, [t, columnar, stats](Recorder& rec) {
+                    if (columnar) {
+                        stats->write_activity(rec.table("activity.tekc", Statistics::activity_columns()), t);
+                    } else {
+                        stats->write_activity(rec.stream("activity.tsv.gz", Statistics::activity_header()), t);
+                    }
+                }));
             }
-            if (static_cast<bool>(flags & Recording::fitness)) {
-                auto ioflag = (t > record_interval) ? std::ios::app : std::ios::out;
-                wtl::zlib::ofstream ozf("fitness.tsv.gz", ioflag);
-                if (t == record_interval) {
-                    ozf << "generation\tfitness\n";
-                }
-                for (const double w: fitness_record) {
-                    ozf << t << "\t" << w << "\n";
-                }
+            if (static_cast<bool>(flags & Recording::statistics)) {
+                recorder.push(timed(Phase::write_statistics, t, profile_writers, [t, stats](Recorder& rec) {
+                    stats->write_species(rec.stream("species.tsv.gz", Statistics::species_header()), t);
+                    stats->write_copy_number(rec.stream("copy_number.tsv.gz", Statistics::copy_number_header()), t);
+                }));
+            }
+            if (static_cast<bool>(flags & Recording::diversity)) {
+                stopwatch.lap(Phase::snapshot);
+                auto diversity = std::make_shared<Diversity>(collect_diversity(t));
+                stopwatch.lap(Phase::diversity);
+                recorder.push(timed(Phase::write_diversity, t, profile_writers, [t, diversity](Recorder& rec) {
+                    diversity->write_diversity(rec.stream("diversity.tsv.gz", Diversity::diversity_header()), t);
+                    diversity->write_divergence(rec.stream("divergence.tsv.gz", Diversity::divergence_header()), t);
+                    diversity->write_distances(rec.stream("distance.tsv.gz", Diversity::distances_header()), t);
+                }));
+            }
+            if (static_cast<bool>(flags & Recording::sites)) {
+                stopwatch.lap(Phase::snapshot);
+                auto sites = std::make_shared<SiteFrequency>(collect_site_frequency());
+                stopwatch.lap(Phase::site_frequency);
+                recorder.push(timed(Phase::write_sites, t, profile_writers, [t, sites](Recorder& rec) {
+                    sites->write_spectrum(rec.stream("sfs.tsv.gz", SiteFrequency::spectrum_header()), t);
+                    sites->write_top(rec.stream("top_sites.tsv.gz", SiteFrequency::top_header()), t, param().TOP_SITES);
+                }));
+            }
+            if (fitness_rows) {
+                recorder.push(timed(Phase::write_fitness, t, profile_writers, [t, columnar, record = std::move(fitness_record)](Recorder& rec) {
+                    if (columnar) {
+                        auto& table = rec.table("fitness.tekc", {ColumnSpec::of<double>("fitness")});
+                        table.append(0u, record);
+                        table.write_chunk(t);
+                        return;
+                    }
+                    auto& ost = rec.stream("fitness.tsv.gz", "generation\tfitness\n");
+                    for (const double w: record) {
+                        ost << t << "\t" << w << "\n";
+                    }
+                }));
             }
             if (static_cast<bool>(flags & Recording::sequence)) {
-                std::ostringstream outfile;
-                outfile << "generation_" << wtl::setfill0w(5) << t << ".fa.gz";
-                wtl::zlib::ofstream ozf(outfile.str());
-                write_fasta(ozf, param().SAMPLE_SIZE);
+                recorder.push(timed(Phase::write_sequence, t, profile_writers, [t, sample = FastaSample(gametes_, param().SAMPLE_SIZE)](Recorder& rec) {
+                    std::ostringstream outfile;
+                    outfile << "generation_" << wtl::setfill0w(5) << t << ".fa.gz";
+                    auto ozf = rec.open(outfile.str());
+                    sample.write(*ozf);
+                    ozf->close();
+                }));
             }
+            if (static_cast<bool>(flags & Recording::alleles)) {
+                recorder.push(timed(Phase::write_alleles, t, profile_writers, [t, sample = FastaSample(gametes_, param().SAMPLE_SIZE)](Recorder& rec) {
+                    std::ostringstream prefix;
+                    prefix << "generation_" << wtl::setfill0w(5) << t;
+                    auto fasta = rec.open(prefix.str() + ".alleles.fa.gz");
+                    auto table = rec.open(prefix.str() + ".copies.tsv.gz");
+                    sample.write_alleles(*fasta, *table);
+                    fasta->close();
+                    table->close();
+                }));
+            }
+            if (static_cast<bool>(flags & Recording::delta)) {
+                recorder.push(timed(Phase::write_delta, t, profile_writers, [t, series, sample = FastaSample(gametes_, param().SAMPLE_SIZE)](Recorder& rec) {
+                    sample.write_delta(series.get(),
+                      rec.stream("alleles.tsv.gz", AlleleSeries::alleles_header()),
+                      rec.stream("copies.tsv.gz", AlleleSeries::copies_header()), t);
+                }));
+            }
+            if (static_cast<bool>(flags & Recording::memory)) {
+                std::ostringstream row;
+                write_memory(row, t);
+                recorder.push([row = row.str()](Recorder& rec) {
+                    rec.stream("memory.tsv.gz", memory_header()) << row;
+                });
+            }
+            stopwatch.lap(Phase::snapshot);
         } else {
             DCERR("." << std::flush);
+            extinct = is_extinct();
+        }
+        if (param().MEMORY_BUDGET > 0u && !over_budget) {
+            const uint64_t rss = MemoryCounter::resident_bytes();
+            if (rss > (static_cast<uint64_t>(param().MEMORY_BUDGET) << 20u)) {
+                over_budget = true;
+                std::cerr << "\nWarning: RSS " << (rss >> 20u) << " MiB exceeds --memory-budget "
+                          << param().MEMORY_BUDGET << " MiB at generation " << t << std::endl;
+                if (param().CHECKPOINT) {
+                    std::ostringstream outfile;
+                    outfile << "checkpoint_" << wtl::setfill0w(5) << t << ".bin.gz";
+                    BgzfStream ost(outfile.str());
+                    save(ost);
+                }
+            }
         }
-        if (is_extinct()) {
-            std::cerr << "Extinction!" << std::endl;
+        if (Metrics::enabled()) {
+            metrics.resident_bytes = MemoryCounter::resident_bytes();
+            metrics.state = (extinct || inactive) ? RunState::extinct : RunState::running;
+            Metrics::publish(metrics);
+        }
+        if (Profile::enabled()) {
+            Profile::merge();
+            const Profile row = Profile::take();
+            row.write(profile_ofs, t);
+            profile_total += row;
+        }
+        if (extinct || inactive) {
+            close_recorder(t);
+            Genealogy::enabled(false);
+            std::cerr << (extinct ? "Extinction!" : "Inactivation!") << std::endl;
             return false;
         }
     }
+    if (genealogy) {
+        Genealogy::simplify(gametes_);
+        BgzfStream ost("genealogy.tsv.gz");
+        Genealogy::write(ost, gametes_);
+        Genealogy::enabled(false);
+    }
+    close_recorder(max_generations);
+    metrics.state = RunState::finished;
+    Metrics::publish(metrics);
     std::cerr << std::endl;
     return true;
 }
 
-std::vector<double> Population::step(const double previous_max_fitness) {
+Establishment Population::establish(const size_t max_generations) {HERE;
+    if (param().NUM_DEMES > 1u) {
+        throw std::runtime_error("establishment attempts do not support demes");
+    }
+    constexpr double margin = 0.1;
+    const size_t max_attempts = param().ESTABLISH_ATTEMPTS;
+    const size_t threshold = param().ESTABLISH_COPIES;
+    const uint64_t base = SEEDER_();
+    Genealogy::enabled(false);
+    std::atomic<size_t> next{0u};
+    std::atomic<size_t> winner{max_attempts};
+    std::mutex mtx;
+    Establishment result;
+    std::vector<Haploid> established;
+    Haploid::coefs_gp_type established_coefs;
+    auto task = [&,this](bool dummy) {
+        std::vector<Haploid> nextgen;
+        while (dummy) {
+            const size_t k = next.fetch_add(1u, std::memory_order_relaxed);
+            if (k >= winner.load(std::memory_order_relaxed)) break;
+            const uint64_t seed = attempt_seed(base, k);
+            Haploid::URBG engine(seed);
+            Haploid::reset_thread_state();
+            std::vector<Haploid> gametes(gametes_);
+            // new sites of an attempt depend only on its seed, not on other attempts
+            Haploid::coefs_gp_type coefs(Haploid::SELECTION_COEFS_GP());
+            ScopedCoefsGp scoped_coefs(&coefs);
+            double max_fitness = 1.0;
+            size_t copies = count_copies(gametes);
+            size_t generation = 0u;
+            bool cancelled = false;
+            // at least one generation so that generations == 0 means failure
+            while (copies > 0u && (generation == 0u || (copies < threshold && generation < max_generations))) {
+                if (k > winner.load(std::memory_order_relaxed)) {
+                    cancelled = true;
+                    break;
+                }
+                max_fitness = step_serial(gametes, &nextgen, engine, max_fitness);
+                max_fitness = std::min(max_fitness + margin, 1.0);
+                gametes.swap(nextgen);
+                copies = count_copies(gametes);
+                ++generation;
+            }
+            if (cancelled || copies == 0u) continue;
+            std::lock_guard<std::mutex> lock(mtx);
+            if (k < winner.load(std::memory_order_relaxed)) {
+                winner.store(k, std::memory_order_relaxed);
+                result.attempt = k;
+                result.seed = seed;
+                result.generations = generation;
+                result.copies = copies;
+                established.swap(gametes);
+                established_coefs.swap(coefs);
+            }
+        }
+    };
+    auto& pool = thread_pool();
+    std::vector<std::future<void>> ftrs;
+    for (size_t i=0u; i<param().CONCURRENCY; ++i) {
+        ftrs.emplace_back(pool.submit(task, true));
+    }
+    for (auto& f: ftrs) f.get();
+    if (result.generations > 0u) {
+        gametes_.swap(established);
+        Haploid::SELECTION_COEFS_GP(std::move(established_coefs));
+        recount();
+    }
+    return result;
+}
+
+//! index of a kernel in a table of 8 template instances
+inline unsigned int kernel_index() {
+    return (Transposon::has_species() ? 4u : 0u)
+         | (Haploid::param().EXCISION_RATE > 0.0 ? 2u : 0u)
+         | (is_the_time ? 1u : 0u);
+}
+
+FitnessSketch Population::step(const double previous_max_fitness, std::vector<double>* fitness_record) {
+    using kernel_type = FitnessSketch (Population::*)(double, std::vector<double>*);
+    static constexpr kernel_type kernels[] = {
+        &Population::step_kernel<false, false, false>,
+        &Population::step_kernel<false, false, true>,
+        &Population::step_kernel<false, true, false>,
+        &Population::step_kernel<false, true, true>,
+        &Population::step_kernel<true, false, false>,
+        &Population::step_kernel<true, false, true>,
+        &Population::step_kernel<true, true, false>,
+        &Population::step_kernel<true, true, true>,
+    };
+    static constexpr kernel_type demes_kernels[] = {
+        &Population::step_demes<false, false, false>,
+        &Population::step_demes<false, false, true>,
+        &Population::step_demes<false, true, false>,
+        &Population::step_demes<false, true, true>,
+        &Population::step_demes<true, false, false>,
+        &Population::step_demes<true, false, true>,
+        &Population::step_demes<true, true, false>,
+        &Population::step_demes<true, true, true>,
+    };
+    static constexpr kernel_type batch_kernels[] = {
+        &Population::step_batch<false, false, false>,
+        &Population::step_batch<false, false, true>,
+        &Population::step_batch<false, true, false>,
+        &Population::step_batch<false, true, true>,
+        &Population::step_batch<true, false, false>,
+        &Population::step_batch<true, false, true>,
+        &Population::step_batch<true, true, false>,
+        &Population::step_batch<true, true, true>,
+    };
+    const auto* table = (param().NUM_DEMES > 1u) ? demes_kernels
+                      : (param().BATCH_SIZE > 0u) ? batch_kernels : kernels;
+    const auto kernel = table[kernel_index()];
+    return (this->*kernel)(previous_max_fitness, fitness_record);
+}
+
+template <bool Speciation, bool Excision, bool Hyperactivation>
+FitnessSketch Population::step_kernel(const double previous_max_fitness, std::vector<double>* fitness_record) {
     const size_t num_gametes = gametes_.size();
-    static wtl::ThreadPool pool(param().CONCURRENCY);
+    auto& pool = thread_pool();
     static std::mutex mtx;
     static std::vector<Haploid> nextgen;
     static std::vector<std::future<void>> ftrs;
-    nextgen.reserve(num_gametes);
+    nextgen.resize(num_gametes);
     ftrs.reserve(num_gametes);
-    std::vector<double> fitness_record;
-    fitness_record.reserve(num_gametes);
-    auto task = [num_gametes,previous_max_fitness,&fitness_record,this](bool dummy) {
+    if (fitness_record) fitness_record->assign(num_gametes / 2u, 0.0);
+    FitnessSketch sketch;
+    Census counts;
+    std::atomic<size_t> num_attempts{0u};
+    // next individual of #nextgen to be filled; claimed without the lock
+    std::atomic<size_t> next_slot{0u};
+    auto task = [num_gametes,previous_max_fitness,fitness_record,&sketch,&counts,&num_attempts,&next_slot,this](bool dummy) {
         Haploid::URBG engine(SEEDER_());
         std::uniform_int_distribution<size_t> dist_idx(0u, num_gametes / 2u - 1u);
+        FitnessSketch local_sketch;
+        Census local_counts;
+        size_t attempts = 0u;
         while (dummy) {
+            Stopwatch stopwatch;
+            Profile::count(Event::attempt);
+            ++attempts;
             const size_t mother_idx = dist_idx(engine);
             size_t father_idx = 0u;
             while ((father_idx = dist_idx(engine)) == mother_idx) {;}
@@ -119,18 +657,38 @@ std::vector<double> Population::step(const double previous_max_fitness) {
             const auto& mother_rchr = gametes_[2u * mother_idx + 1u];
             const auto& father_lchr = gametes_[2u * father_idx];
             const auto& father_rchr = gametes_[2u * father_idx + 1u];
+            stopwatch.lap(Phase::sampling);
             auto egg   = mother_lchr.gametogenesis(mother_rchr, engine);
             auto sperm = father_lchr.gametogenesis(father_rchr, engine);
-            const double fitness = egg.fitness(sperm);
+            stopwatch.lap(Phase::gametogenesis);
+            const double fitness = egg.fitness<Speciation>(sperm);
+            stopwatch.lap(Phase::fitness);
             if (fitness < wtl::generate_canonical(engine) * previous_max_fitness) continue;
-            egg.transpose_mutate(sperm, engine);
+            egg.transpose_mutate<Excision>(sperm, engine);
+            stopwatch.lap(Phase::transpose_mutate);
+            if (Hyperactivation) {
+                std::lock_guard<std::mutex> lock(mtx);
+                once_in_a_run(0, 0, &egg);
+            }
+            // each slot is owned by one thread, so the rest needs no lock
+            const size_t slot = next_slot.fetch_add(1u, std::memory_order_relaxed);
+            if (2u * slot >= num_gametes) break;
+            Profile::count(Event::acceptance);
+            Profile::count(Event::transposon, egg.size() + sperm.size());
+            local_sketch.add(fitness);
+            local_counts.add(egg, sperm);
+            if (fitness_record) (*fitness_record)[slot] = fitness;
+            nextgen[2u * slot] = std::move(egg);
+            nextgen[2u * slot + 1u] = std::move(sperm);
+            stopwatch.lap(Phase::store_offspring);
+        }
+        {
             std::lock_guard<std::mutex> lock(mtx);
-            once_in_a_run(0, 0, &egg);
-            if (nextgen.size() >= num_gametes) break;
-            fitness_record.push_back(fitness);
-            nextgen.push_back(std::move(egg));
-            nextgen.push_back(std::move(sperm));
+            sketch += local_sketch;
+            counts += local_counts;
         }
+        num_attempts.fetch_add(attempts, std::memory_order_relaxed);
+        Profile::merge();
     };
     for (size_t i=0u; i<param().CONCURRENCY; ++i) {
         ftrs.emplace_back(pool.submit(task, true)); // dummy for future
@@ -140,16 +698,311 @@ std::vector<double> Population::step(const double previous_max_fitness) {
     ftrs.clear();
     gametes_.swap(nextgen);
     nextgen.clear();
-    return fitness_record;
+    counts_ = std::move(counts);
+    num_attempts_ = num_attempts.load(std::memory_order_relaxed);
+    return sketch;
+}
+
+template <bool Speciation, bool Excision, bool Hyperactivation>
+FitnessSketch Population::step_batch(const double previous_max_fitness, std::vector<double>* fitness_record) {
+    const size_t num_gametes = gametes_.size();
+    const size_t batch_size = param().BATCH_SIZE;
+    auto& pool = thread_pool();
+    static std::mutex mtx;
+    static std::vector<Haploid> nextgen;
+    nextgen.resize(num_gametes);
+    if (fitness_record) fitness_record->assign(num_gametes / 2u, 0.0);
+    GameteTable table(gametes_);
+    std::vector<std::future<void>> ftrs;
+    ftrs.reserve(param().CONCURRENCY);
+    for (size_t j=0u; j<param().CONCURRENCY; ++j) {
+        ftrs.emplace_back(pool.submit([num_gametes,&table](size_t j) {
+            const size_t concurrency = param().CONCURRENCY;
+            table.fill(num_gametes * j / concurrency, num_gametes * (j + 1u) / concurrency);
+        }, j));
+    }
+    for (auto& f: ftrs) f.get();
+    ftrs.clear();
+    FitnessSketch sketch;
+    Census counts;
+    std::atomic<size_t> num_attempts{0u};
+    // next individual of #nextgen to be filled; claimed without the lock
+    std::atomic<size_t> next_slot{0u};
+    auto task = [num_gametes,batch_size,previous_max_fitness,fitness_record,&table,&sketch,&counts,&num_attempts,&next_slot,this](bool) {
+        Haploid::URBG engine(SEEDER_());
+        std::uniform_int_distribution<size_t> dist_idx(0u, num_gametes / 2u - 1u);
+        std::vector<Proposal> proposals(batch_size);
+        std::vector<Haploid::position_t> chiasmata;
+        std::vector<double> fitness(batch_size);
+        std::vector<size_t> accepted;
+        accepted.reserve(batch_size);
+        FitnessSketch local_sketch;
+        Census local_counts;
+        size_t attempts = 0u;
+        while (2u * next_slot.load(std::memory_order_relaxed) < num_gametes) {
+            Stopwatch stopwatch;
+            Profile::count(Event::attempt, batch_size);
+            attempts += batch_size;
+            // draws in the same order as step_kernel() for each candidate
+            chiasmata.clear();
+            for (auto& x: proposals) {
+                x.mother = dist_idx(engine);
+                while ((x.father = dist_idx(engine)) == x.mother) {;}
+                x.egg_flg = (wtl::generate_canonical(engine) < 0.5);
+                x.egg_chiasmata = static_cast<uint32_t>(chiasmata.size());
+                const auto& egg_chiasmata = Haploid::sample_chiasmata(engine);
+                chiasmata.insert(chiasmata.end(), egg_chiasmata.begin(), egg_chiasmata.end());
+                x.sperm_flg = (wtl::generate_canonical(engine) < 0.5);
+                x.sperm_chiasmata = static_cast<uint32_t>(chiasmata.size());
+                const auto& sperm_chiasmata = Haploid::sample_chiasmata(engine);
+                chiasmata.insert(chiasmata.end(), sperm_chiasmata.begin(), sperm_chiasmata.end());
+            }
+            stopwatch.lap(Phase::sampling);
+            for (size_t b=0u; b<batch_size; ++b) {
+                fitness[b] = table.fitness<Speciation>(proposals[b], chiasmata);
+            }
+            stopwatch.lap(Phase::fitness);
+            accepted.clear();
+            for (size_t b=0u; b<batch_size; ++b) {
+                if (!(fitness[b] < wtl::generate_canonical(engine) * previous_max_fitness)) {
+                    accepted.push_back(b);
+                }
+            }
+            for (const size_t b: accepted) {
+                const auto& x = proposals[b];
+                auto egg = gametes_[2u * x.mother].gametogenesis(
+                    gametes_[2u * x.mother + 1u], x.egg_flg, &chiasmata[x.egg_chiasmata]);
+                auto sperm = gametes_[2u * x.father].gametogenesis(
+                    gametes_[2u * x.father + 1u], x.sperm_flg, &chiasmata[x.sperm_chiasmata]);
+                stopwatch.lap(Phase::gametogenesis);
+                egg.transpose_mutate<Excision>(sperm, engine);
+                stopwatch.lap(Phase::transpose_mutate);
+                if (Hyperactivation) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    once_in_a_run(0, 0, &egg);
+                }
+                const size_t slot = next_slot.fetch_add(1u, std::memory_order_relaxed);
+                if (2u * slot >= num_gametes) break;
+                Profile::count(Event::acceptance);
+                Profile::count(Event::transposon, egg.size() + sperm.size());
+                local_sketch.add(fitness[b]);
+                local_counts.add(egg, sperm);
+                if (fitness_record) (*fitness_record)[slot] = fitness[b];
+                nextgen[2u * slot] = std::move(egg);
+                nextgen[2u * slot + 1u] = std::move(sperm);
+                stopwatch.lap(Phase::store_offspring);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            sketch += local_sketch;
+            counts += local_counts;
+        }
+        num_attempts.fetch_add(attempts, std::memory_order_relaxed);
+        Profile::merge();
+    };
+    for (size_t i=0u; i<param().CONCURRENCY; ++i) {
+        ftrs.emplace_back(pool.submit(task, true));
+    }
+    for (auto& f: ftrs) f.get();
+    gametes_.swap(nextgen);
+    nextgen.clear();
+    counts_ = std::move(counts);
+    num_attempts_ = num_attempts.load(std::memory_order_relaxed);
+    return sketch;
+}
+
+template <bool Speciation, bool Excision, bool Hyperactivation>
+FitnessSketch Population::step_demes(const double previous_max_fitness, std::vector<double>* fitness_record) {
+    const size_t num_individuals = gametes_.size() / 2u;
+    const unsigned int num_demes = param().NUM_DEMES;
+    if (num_individuals < 2u * num_demes) {
+        throw std::runtime_error("each deme needs two or more individuals");
+    }
+    auto& pool = thread_pool();
+    static std::vector<Haploid> nextgen;
+    static std::vector<double> nextgen_fitness;
+    nextgen.resize(gametes_.size());
+    nextgen_fitness.resize(num_individuals);
+    std::vector<Census> counts(num_demes);
+    std::vector<Inbox<Migrant>> inboxes(num_demes);
+    std::vector<std::mt19937_64::result_type> seeds(num_demes);
+    for (auto& x: seeds) x = SEEDER_();
+    std::atomic<size_t> num_attempts{0u};
+    std::atomic<size_t> num_migrants{0u};
+    auto task = [num_individuals,num_demes,previous_max_fitness,&counts,&inboxes,&seeds,&num_attempts,&num_migrants,this](const unsigned int deme) {
+        Haploid::URBG engine(seeds[deme]);
+        const size_t begin = num_individuals * deme / num_demes;
+        const size_t end = num_individuals * (deme + 1u) / num_demes;
+        std::uniform_int_distribution<size_t> dist_idx(begin, end - 1u);
+        std::uniform_int_distribution<unsigned int> dist_deme(0u, num_demes - 2u);
+        std::bernoulli_distribution bern_migration(param().MIGRATION_RATE);
+        auto& deme_counts = counts[deme];
+        size_t attempts = 0u;
+        size_t migrants = 0u;
+        // each slot sends at most one offspring away, so that migrants ~ Binomial(size, rate)
+        bool has_sent = false;
+        for (size_t i=begin; i<end;) {
+            Stopwatch stopwatch;
+            Profile::count(Event::attempt);
+            ++attempts;
+            const size_t mother_idx = dist_idx(engine);
+            size_t father_idx = 0u;
+            while ((father_idx = dist_idx(engine)) == mother_idx) {;}
+            const auto& mother_lchr = gametes_[2u * mother_idx];
+            const auto& mother_rchr = gametes_[2u * mother_idx + 1u];
+            const auto& father_lchr = gametes_[2u * father_idx];
+            const auto& father_rchr = gametes_[2u * father_idx + 1u];
+            stopwatch.lap(Phase::sampling);
+            auto egg   = mother_lchr.gametogenesis(mother_rchr, engine);
+            auto sperm = father_lchr.gametogenesis(father_rchr, engine);
+            stopwatch.lap(Phase::gametogenesis);
+            const double fitness = egg.fitness<Speciation>(sperm);
+            stopwatch.lap(Phase::fitness);
+            if (fitness < wtl::generate_canonical(engine) * previous_max_fitness) continue;
+            egg.transpose_mutate<Excision>(sperm, engine);
+            stopwatch.lap(Phase::transpose_mutate);
+            // hyperactivation is introduced into the first deme only
+            if (Hyperactivation && deme == 0u) once_in_a_run(0, 0, &egg);
+            Profile::count(Event::acceptance);
+            Profile::count(Event::transposon, egg.size() + sperm.size());
+            if (!has_sent && bern_migration(engine)) {
+                // the migrant leaves, and the slot is filled by another offspring
+                Profile::count(Event::migration);
+                has_sent = true;
+                ++migrants;
+                unsigned int destination = dist_deme(engine);
+                if (destination >= deme) ++destination;
+                inboxes[destination].push(Migrant{std::move(egg), std::move(sperm), fitness});
+                continue;
+            }
+            deme_counts.add(egg, sperm);
+            nextgen_fitness[i] = fitness;
+            nextgen[2u * i] = std::move(egg);
+            nextgen[2u * i + 1u] = std::move(sperm);
+            has_sent = false;
+            ++i;
+        }
+        num_attempts.fetch_add(attempts, std::memory_order_relaxed);
+        num_migrants.fetch_add(migrants, std::memory_order_relaxed);
+        Profile::merge();
+    };
+    std::vector<std::future<void>> ftrs;
+    ftrs.reserve(num_demes);
+    for (unsigned int deme=0u; deme<num_demes; ++deme) {
+        ftrs.emplace_back(pool.submit(task, deme));
+    }
+    for (auto& f: ftrs) f.get();
+    // generation boundary: immigrants replace distinct residents chosen at random
+    Haploid::URBG engine(SEEDER_());
+    std::vector<size_t> slots;
+    for (unsigned int deme=0u; deme<num_demes; ++deme) {
+        const size_t begin = num_individuals * deme / num_demes;
+        const size_t end = num_individuals * (deme + 1u) / num_demes;
+        slots.resize(end - begin);
+        std::iota(slots.begin(), slots.end(), begin);
+        size_t k = 0u;
+        for (auto& immigrant: inboxes[deme].drain()) {
+            // immigrants beyond the deme size are lost
+            if (k == slots.size()) break;
+            std::uniform_int_distribution<size_t> dist_slot(k, slots.size() - 1u);
+            std::swap(slots[k], slots[dist_slot(engine)]);
+            const size_t i = slots[k++];
+            counts[deme].remove(nextgen[2u * i], nextgen[2u * i + 1u]);
+            counts[deme].add(immigrant.egg, immigrant.sperm);
+            nextgen_fitness[i] = immigrant.fitness;
+            nextgen[2u * i] = std::move(immigrant.egg);
+            nextgen[2u * i + 1u] = std::move(immigrant.sperm);
+        }
+    }
+    gametes_.swap(nextgen);
+    nextgen.clear();
+    num_attempts_ = num_attempts.load(std::memory_order_relaxed);
+    num_migrants_ = num_migrants.load(std::memory_order_relaxed);
+    for (size_t deme=1u; deme<num_demes; ++deme) {
+        counts[0u] += counts[deme];
+    }
+    counts_ = std::move(counts[0u]);
+    FitnessSketch sketch;
+    for (const double x: nextgen_fitness) sketch.add(x);
+    if (fitness_record) {
+        fitness_record->assign(nextgen_fitness.begin(), nextgen_fitness.end());
+    }
+    return sketch;
 }
 
-void Population::eval_species_distance() {
-    std::unordered_map<uint_fast32_t, TransposonFamily> counter;
-    for (const auto& chr: gametes_) {
-        for (const auto& p: chr) {
-            counter[p.second->species()].collect(*p.second);
+Statistics Population::collect_statistics(const bool with_families) const {
+    const size_t num_individuals = gametes_.size() / 2u;
+    const size_t concurrency = param().CONCURRENCY;
+    std::vector<Statistics> partial(concurrency, Statistics(with_families));
+    std::vector<std::future<void>> ftrs;
+    ftrs.reserve(concurrency);
+    for (size_t j=0u; j<concurrency; ++j) {
+        ftrs.emplace_back(thread_pool().submit([this,num_individuals,concurrency,&partial](size_t j) {
+            const size_t begin = num_individuals * j / concurrency;
+            const size_t end = num_individuals * (j + 1u) / concurrency;
+            for (size_t i=begin; i<end; ++i) {
+                partial[j].collect(gametes_[2u * i], gametes_[2u * i + 1u]);
+            }
+        }, j));
+    }
+    for (auto& f: ftrs) f.get();
+    for (size_t j=1u; j<concurrency; ++j) {
+        partial[0] += partial[j];
+    }
+    return std::move(partial[0]);
+}
+
+void Population::hyperactivate(const size_t now, const size_t then) {
+    once_in_a_run(now, then);
+}
+
+Statistics Population::census(Stopwatch* stopwatch) {
+    Statistics stats = collect_statistics(Transposon::can_speciate());
+    stopwatch->lap(Phase::statistics);
+    if (Transposon::can_speciate()) {
+        const bool speciated = eval_species_distance(stats);
+        stopwatch->lap(Phase::species_distance);
+        if (speciated) {
+            stats = collect_statistics(false);
+            recount();
+            stopwatch->lap(Phase::statistics);
         }
     }
+    return stats;
+}
+
+SiteFrequency Population::collect_site_frequency() const {
+    const size_t num_gametes = gametes_.size();
+    const size_t concurrency = param().CONCURRENCY;
+    std::vector<std::future<SiteFrequency>> ftrs;
+    ftrs.reserve(concurrency);
+    for (size_t j=0u; j<concurrency; ++j) {
+        ftrs.emplace_back(thread_pool().submit([this,num_gametes,concurrency](size_t j) {
+            return SiteFrequency(gametes_, num_gametes * j / concurrency, num_gametes * (j + 1u) / concurrency);
+        }, j));
+    }
+    SiteFrequency merged;
+    for (auto& f: ftrs) merged += f.get();
+    return merged;
+}
+
+Diversity Population::collect_diversity(const uint_fast64_t seed) const {
+    Diversity diversity(gametes_, param().DIVERSITY_ALLELES, seed);
+    const size_t concurrency = param().CONCURRENCY;
+    std::vector<std::future<Diversity::Partial>> ftrs;
+    ftrs.reserve(concurrency);
+    for (size_t j=0u; j<concurrency; ++j) {
+        ftrs.emplace_back(thread_pool().submit([&diversity,concurrency](size_t j) {
+            return diversity.compare(j, concurrency);
+        }, j));
+    }
+    for (auto& f: ftrs) diversity += f.get();
+    return diversity;
+}
+
+bool Population::eval_species_distance(const Statistics& stats) {
+    const auto& counter = stats.families();
     std::unordered_map<uint_fast32_t, Transposon> centers;
     for (const auto& p: counter) {
         centers.emplace(p.first, p.second.majority());
@@ -163,17 +1016,38 @@ void Population::eval_species_distance() {
             }
         }
     }
-    if (counter.size() >= param().MAX_COEXISTENCE) return;
+    if (counter.size() >= param().MAX_COEXISTENCE) return false;
+    // centers need the merged families, so the farthest copy takes a second pass;
+    // per-thread maxima are merged in order to keep the first one of ties
+    const size_t num_gametes = gametes_.size();
+    const size_t concurrency = param().CONCURRENCY;
+    std::vector<std::pair<uint_fast32_t, Transposon*>> partial(concurrency, {0u, nullptr});
+    std::vector<std::future<void>> ftrs;
+    ftrs.reserve(concurrency);
+    for (size_t j=0u; j<concurrency; ++j) {
+        ftrs.emplace_back(thread_pool().submit([this,num_gametes,concurrency,&centers,&partial](size_t j) {
+            const size_t begin = num_gametes * j / concurrency;
+            const size_t end = num_gametes * (j + 1u) / concurrency;
+            auto& max = partial[j];
+            for (size_t i=begin; i<end; ++i) {
+                for (const auto& p: gametes_[i]) {
+                    if (p.second->activity() < 0.01) continue;
+                    const auto distance = (*p.second - centers.at(p.second->species()));
+                    if (distance > max.first) {
+                        max.first = distance;
+                        max.second = p.second.get();
+                    }
+                }
+            }
+        }, j));
+    }
+    for (auto& f: ftrs) f.get();
     Transposon* farthest = nullptr;
     uint_fast32_t max_distance = 0;
-    for (const auto& chr: gametes_) {
-        for (const auto& p: chr) {
-            if (p.second->activity() < 0.01) continue;
-            auto distance = (*p.second - centers[p.second->species()]);
-            if (distance > max_distance) {
-                max_distance = distance;
-                farthest = p.second.get();
-            }
+    for (const auto& max: partial) {
+        if (max.first > max_distance) {
+            max_distance = max.first;
+            farthest = max.second;
         }
     }
 
@@ -187,65 +1061,149 @@ void Population::eval_species_distance() {
         for (const auto& p: centers) {
             Transposon::INTERACTION_COEFS_emplace(p.first, farthest->species(), p.second * *farthest);
         }
+        return true;
     }
+    return false;
 }
 
-bool Population::is_extinct() const {
-    return std::all_of(gametes_.begin(), gametes_.end(), [](const Haploid& x) {
-        return x.empty();
-    });
+const char* Population::memory_header() noexcept {
+    return "generation\ttransposons\treferenced\talleles\tsites\tcoefs_gp\t"
+           "transposon_bytes\tsite_bytes\tcoefs_gp_bytes\tgamete_bytes\trss_bytes\n";
 }
 
-void Population::write_activity(std::ostream& ost, const size_t time, const bool header) const {
-    std::map<uint_fast32_t, std::map<double, uint_fast32_t>> counter;
-    for (const auto& chr: gametes_) {
-        for (const auto& p: chr) {
-            const auto& te = *p.second;
-            ++counter[te.species()][te.activity()];
+std::ostream& Population::write_memory(std::ostream& ost, const size_t time) const {
+    struct Hash {
+        size_t operator()(const Transposon* x) const noexcept {return x->hash();}
+    };
+    struct Equal {
+        bool operator()(const Transposon* x, const Transposon* y) const noexcept {return *x == *y;}
+    };
+    std::unordered_set<const Transposon*> referenced;
+    std::unordered_set<const Transposon*, Hash, Equal> alleles;
+    size_t num_sites = 0u;
+    for (const auto& x: gametes_) {
+        num_sites += x.size();
+        for (const auto& p: x) {
+            if (referenced.insert(p.second.get()).second) {
+                alleles.insert(p.second.get());
+            }
         }
     }
-    if (header) {
-        ost << "generation\tspecies\tactivity\tcopy_number\n";
+    return ost << time << "\t"
+        << MemoryCounter::blocks(Subsystem::transposons) << "\t"
+        << referenced.size() << "\t"
+        << alleles.size() << "\t"
+        << num_sites << "\t"
+        << Haploid::SELECTION_COEFS_GP().size() << "\t"
+        << MemoryCounter::bytes(Subsystem::transposons) << "\t"
+        << MemoryCounter::bytes(Subsystem::sites) << "\t"
+        << MemoryCounter::bytes(Subsystem::coefs_gp) << "\t"
+        << gametes_.capacity() * sizeof(Haploid) << "\t"
+        << MemoryCounter::resident_bytes() << "\n";
+}
+
+void Population::recount() {
+    counts_ = Census();
+    for (size_t i=0u; i+1u<gametes_.size(); i+=2u) {
+        counts_.add(gametes_[i], gametes_[i + 1u]);
     }
-    for (const auto& sp: counter) {
-        auto species = sp.first;
-        for (const auto& act_cnt: sp.second) {
-            ost << time << "\t" << species << "\t"
-                << act_cnt.first << "\t" << act_cnt.second << "\n";
+}
+
+void Census::add(const Haploid& x, const Haploid& y) {
+    const uint_fast64_t n = x.size() + y.size();
+    transposons += n;
+    carriers += (n > 0u);
+    for (const Haploid* chr: {&x, &y}) {
+        for (const auto& p: *chr) {
+            active += (p.second->activity() > 0.0);
+            const uint_fast32_t s = p.second->species();
+            if (s >= species.size()) species.resize(s + 1u);
+            ++species[s];
         }
     }
 }
 
-std::ostream& Population::write_summary(std::ostream& ost) const {HERE;
-    nlohmann::json record;
-    for (const auto& x: gametes_) {
-        record.push_back(x.summarize());
+void Census::remove(const Haploid& x, const Haploid& y) {
+    const uint_fast64_t n = x.size() + y.size();
+    transposons -= n;
+    carriers -= (n > 0u);
+    for (const Haploid* chr: {&x, &y}) {
+        for (const auto& p: *chr) {
+            active -= (p.second->activity() > 0.0);
+            --species[p.second->species()];
+        }
+    }
+}
+
+Census& Census::operator+=(const Census& other) {
+    transposons += other.transposons;
+    active += other.active;
+    carriers += other.carriers;
+    if (species.size() < other.species.size()) species.resize(other.species.size());
+    for (size_t i=0u; i<other.species.size(); ++i) {
+        species[i] += other.species[i];
     }
-    return ost << record << "\n";
+    return *this;
+}
+
+size_t Census::num_species() const noexcept {
+    return static_cast<size_t>(std::count_if(species.begin(), species.end(),
+                                             [](uint_fast64_t n) {return n > 0u;}));
+}
+
+std::vector<ColumnSpec> Population::summary_columns() {
+    return {
+      ColumnSpec::of<uint32_t>("gamete"),
+      ColumnSpec::of<int32_t>("site"),
+      ColumnSpec::of<uint32_t>("species"),
+      ColumnSpec::of<uint8_t>("indel"),
+      ColumnSpec::of<uint32_t>("nonsynonymous"),
+      ColumnSpec::of<uint32_t>("synonymous"),
+      ColumnSpec::of<double>("activity")
+    };
 }
 
-std::ostream& Population::write_fasta_individual(std::ostream& ost, const size_t i) const {
-    const size_t idx = 2u * i;
-    std::unordered_map<Transposon*, unsigned int> counter;
-    for (size_t j: {0u, 1u}) {
-        for (const auto& p: gametes_.at(idx + j)) {
-            ++counter[p.second.get()];
+void Population::write_summary(ColumnWriter& table, const size_t generation) const {HERE;
+    std::vector<uint32_t> gamete, species, nonsynonymous, synonymous;
+    std::vector<int32_t> site;
+    std::vector<uint8_t> indel;
+    std::vector<double> activity;
+    for (size_t i=0u; i<gametes_.size(); ++i) {
+        for (const auto& p: gametes_[i]) {
+            const auto& te = *p.second;
+            gamete.push_back(static_cast<uint32_t>(i));
+            site.push_back(p.first);
+            species.push_back(static_cast<uint32_t>(te.species()));
+            indel.push_back(te.has_indel());
+            nonsynonymous.push_back(static_cast<uint32_t>(te.nonsynonymous_sites().count()));
+            synonymous.push_back(static_cast<uint32_t>(te.synonymous_sites().count()));
+            activity.push_back(te.activity());
         }
     }
-    for (const auto& p: counter) {
-        p.first->write_metadata(ost << ">individual=" << i << " ");
-        ost << " copy_number=" << p.second << "\n";
-        p.first->write_sequence(ost) << "\n";
+    table.append(0u, gamete);
+    table.append(1u, site);
+    table.append(2u, species);
+    table.append(3u, indel);
+    table.append(4u, nonsynonymous);
+    table.append(5u, synonymous);
+    table.append(6u, activity);
+    table.write_chunk(generation);
+}
+
+std::ostream& Population::write_summary(std::ostream& ost) const {HERE;
+    TextBuffer buffer(ost);
+    char delimiter = '[';
+    for (const auto& x: gametes_) {
+        x.write_summary(buffer << delimiter);
+        delimiter = ',';
     }
+    buffer << (gametes_.empty() ? "null" : "]") << '\n';
+    buffer.flush();
     return ost;
 }
 
 std::ostream& Population::write_fasta(std::ostream& ost, size_t num_individuals) const {
-    num_individuals = std::min(num_individuals, gametes_.size() / 2u);
-    for (size_t i=0u; i<num_individuals; ++i) {
-        write_fasta_individual(ost, i);
-    }
-    return ost;
+    return FastaSample(gametes_, num_individuals).write(ost);
 }
 
 //! shortcut << Population::gametes_
@@ -253,4 +1211,5 @@ std::ostream& operator<<(std::ostream& ost, const Population& pop) {
     return ost << pop.gametes_;
 }
 
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
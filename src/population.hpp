@@ -5,6 +5,10 @@
 #ifndef TEK_POPULATION_HPP_
 #define TEK_POPULATION_HPP_
 
+#include "length.hpp"
+#include "sketch.hpp"
+
+#include <cstdint>
 #include <iosfwd>
 #include <vector>
 #include <random>
@@ -13,7 +17,18 @@
 
 namespace tek {
 
+class ColumnWriter;
+struct ColumnSpec;
+class Stopwatch;
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
 class Haploid;
+class Statistics;
+class Diversity;
+class SiteFrequency;
+class Simulation;
+class Observation;
 
 //! bits to denote what to record
 enum class Recording: int {
@@ -22,6 +37,15 @@ enum class Recording: int {
     sequence = 0b00000010,
     fitness  = 0b00000100,
     summary  = 0b00001000,
+    columnar = 0b00010000,
+    alleles  = 0b00100000,
+    statistics = 0b01000000,
+    memory   = 0b10000000,
+    genealogy = 0b100000000,
+    diversity = 0b1000000000,
+    sites    = 0b10000000000,
+    delta    = 0b100000000000,
+    sketch   = 0b1000000000000,
 };
 
 //! operator OR
@@ -44,6 +68,66 @@ struct PopulationParams {
     unsigned int CONCURRENCY = 1u;
     //! max number of species that can coexist at a time
     unsigned int MAX_COEXISTENCE = 42u;
+    //! soft limit of resident memory in MiB; 0 for unlimited
+    size_t MEMORY_BUDGET = 0u;
+    //! save a snapshot when #MEMORY_BUDGET is exceeded
+    bool CHECKPOINT = false;
+    //! number of demes in the island model; 1 for a panmictic population
+    unsigned int NUM_DEMES = 1u;
+    //! probability that an offspring moves to another deme and replaces a resident there
+    double MIGRATION_RATE = 0.0;
+    //! max number of unique alleles compared pairwise for Recording::diversity
+    size_t DIVERSITY_ALLELES = 2000u;
+    //! number of the most frequent sites written for Recording::sites
+    size_t TOP_SITES = 20u;
+    //! TE copies to regard an attempt as established; 0 to start without attempts
+    size_t ESTABLISH_COPIES = 0u;
+    //! generations to regard a surviving attempt as established
+    size_t ESTABLISH_GENERATIONS = 100u;
+    //! max number of establishment attempts per round
+    size_t ESTABLISH_ATTEMPTS = 10000u;
+    //! end a run as doomed when no active TE remains
+    bool STOP_INACTIVE = false;
+    //! candidate offspring drawn and evaluated together by each thread; 0 for one at a time
+    size_t BATCH_SIZE = 0u;
+};
+
+/*! @brief Totals over the population maintained by Population::step()
+
+    Each thread counts the offspring it produces,
+    and the partial counts are merged at the end of a generation,
+    so that reading them costs nothing.
+*/
+struct Census {
+    //! number of TE copies
+    uint_fast64_t transposons = 0u;
+    //! number of TE copies with positive activity
+    uint_fast64_t active = 0u;
+    //! number of individuals carrying TEs
+    uint_fast64_t carriers = 0u;
+    //! number of TE copies indexed by species
+    std::vector<uint_fast64_t> species;
+
+    //! count an individual
+    void add(const Haploid&, const Haploid&);
+    //! uncount an individual
+    void remove(const Haploid&, const Haploid&);
+    //! merge partial counts
+    Census& operator+=(const Census&);
+    //! number of species with TE copies
+    size_t num_species() const noexcept;
+};
+
+//! @brief Result of Population::establish()
+struct Establishment {
+    //! index of the established attempt; the preceding ones went extinct
+    size_t attempt = 0u;
+    //! seed of Haploid::URBG used throughout the attempt
+    uint64_t seed = 0u;
+    //! generations simulated by the attempt; 0 if all attempts went extinct
+    size_t generations = 0u;
+    //! number of TE copies at the end of the attempt
+    size_t copies = 0u;
 };
 
 /*! @brief Population class
@@ -64,6 +148,10 @@ class Population {
 
     //! constructor
     Population(size_t size, size_t num_founders=1);
+    //! construct from a snapshot written by save()
+    explicit Population(std::istream&);
+    //! construct from gametes for tests and benchmarks; Haploid::initialize() is not called
+    explicit Population(std::vector<Haploid>&& gametes);
     //! default copy constructor
     Population(const Population& other) = default;
     //! destructor
@@ -72,15 +160,46 @@ class Population {
     //! return false if TE is extinct
     bool evolve(size_t max_generations, size_t record_interval,
                 Recording flags=Recording::activity | Recording::fitness,
-                size_t t_hyperactivate = 0u);
+                size_t t_hyperactivate = 0u, size_t first_generation = 1u);
+    /*! @brief run independent attempts from this population in parallel until one is established
+
+        Each attempt runs single-threaded with its own seed and its own copy of
+        the selection coefficients, until it goes extinct,
+        carries #PopulationParams::ESTABLISH_COPIES TEs, or survives `max_generations`.
+        The established attempt with the smallest index replaces this population
+        together with its coefficients,
+        so that the result does not depend on thread timing or on the other attempts.
+    */
+    Establishment establish(size_t max_generations);
 
+    /*! @brief proceed one generation and return fitness distribution of offspring
+        @param fitness_record if not null, filled with fitness of each offspring
+    */
+    FitnessSketch step(double previous_max_fitness=1.0, std::vector<double>* fitness_record=nullptr);
+    //! vector of chromosomes; (2i, 2i + 1) is the i-th individual
+    const std::vector<Haploid>& gametes() const noexcept {return gametes_;}
+    //! totals updated by step()
+    const Census& counts() const noexcept {return counts_;}
+    //! number of offspring that moved to another deme in the last step()
+    size_t num_migrants() const noexcept {return num_migrants_;}
+
+    //! write a binary snapshot of gametes, TE species, and selection coefficients
+    std::ostream& save(std::ostream&) const;
+    //! write counts and bytes of TEs, sites, and global tables, and RSS
+    std::ostream& write_memory(std::ostream&, size_t time) const;
+    //! header for write_memory()
+    static const char* memory_header() noexcept;
     //! write summary in JSON format
     std::ostream& write_summary(std::ostream&) const;
-    //! count identicals and write FASTA for i-th individual
-    std::ostream& write_fasta_individual(std::ostream&, size_t i) const;
-    //! call write_fasta_individual() repeatedly
+    //! write summary as a chunk of columnar records
+    void write_summary(ColumnWriter&, size_t generation) const;
+    //! columns for write_summary(ColumnWriter&, size_t)
+    static std::vector<ColumnSpec> summary_columns();
+    //! write FASTA of the first individuals, each distinct TE once with its copy number
     std::ostream& write_fasta(std::ostream&, size_t num_individuals=-1u) const;
     friend std::ostream& operator<<(std::ostream&, const Population&);
+    friend class Simulation;
+    friend class Observation;
 
     //! Set #PARAM_
     static void param(const param_type& p) {PARAM_ = p;}
@@ -95,19 +214,54 @@ class Population {
     //! seed generator for Haploid::URBG
     static std::mt19937_64 SEEDER_;
 
-    //! proceed one generation and return fitness record
-    std::vector<double> step(double previous_max_fitness=1.0);
-    //! find farthest element, count species, and cause speciation if qualified
-    void eval_species_distance();
+    /*! @brief step() of a panmictic population specialized for the features in use
+
+        `Speciation` is false if all TEs are in one species,
+        `Excision` is false if HaploidParams::EXCISION_RATE is zero, and
+        `Hyperactivation` is true only while a hyperactivation is pending.
+    */
+    template <bool Speciation, bool Excision, bool Hyperactivation>
+    FitnessSketch step_kernel(double previous_max_fitness, std::vector<double>* fitness_record);
+    /*! @brief step_kernel() in batches of #PopulationParams::BATCH_SIZE candidates
+
+        Each thread draws parents and chiasmata of a batch,
+        evaluates their fitness from a GameteTable,
+        draws acceptance for all of them,
+        and then builds and mutates only the accepted offspring.
+    */
+    template <bool Speciation, bool Excision, bool Hyperactivation>
+    FitnessSketch step_batch(double previous_max_fitness, std::vector<double>* fitness_record);
+    //! step_kernel() of #PopulationParams::NUM_DEMES demes in parallel, then migration
+    template <bool Speciation, bool Excision, bool Hyperactivation>
+    FitnessSketch step_demes(double previous_max_fitness, std::vector<double>* fitness_record);
+    //! hyperactivate a TE in the next step() if `now == then`
+    static void hyperactivate(size_t now, size_t then);
+    //! collect Statistics of all the individuals in parallel
+    Statistics collect_statistics(bool with_families) const;
+    //! collect Statistics and update species if TEs can speciate
+    Statistics census(Stopwatch*);
+    //! compare unique alleles pairwise in parallel
+    Diversity collect_diversity(uint_fast64_t seed) const;
+    //! count gametes carrying each insertion site in parallel
+    SiteFrequency collect_site_frequency() const;
+    //! find farthest element, count species, and return true if speciation occurred
+    bool eval_species_distance(const Statistics&);
+    //! count #counts_ from scratch
+    void recount();
     //! return true if no TE exists in #gametes_
-    bool is_extinct() const;
-    //! summarize and write activity
-    void write_activity(std::ostream&, size_t time, bool header) const;
+    bool is_extinct() const noexcept {return counts_.transposons == 0u;}
 
     //! vector of chromosomes, not individuals
     std::vector<Haploid> gametes_;
+    //! number of mating attempts in the last step()
+    size_t num_attempts_ = 0u;
+    //! number of migrants in the last step()
+    size_t num_migrants_ = 0u;
+    //! totals over #gametes_
+    Census counts_;
 };
 
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
 
 #endif /* TEK_POPULATION_HPP_ */
@@ -0,0 +1,146 @@
+/*! @file profile.cpp
+    @brief Implementation of Profile class
+*/
+#include "profile.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <mutex>
+
+namespace tek {
+
+namespace {
+constexpr const char* PHASE_NAMES[] = {
+    "sampling",
+    "gametogenesis",
+    "fitness",
+    "transpose_mutate",
+    "store_offspring",
+    "statistics",
+    "species_distance",
+    "simplify",
+    "diversity",
+    "site_frequency",
+    "snapshot",
+    "write_activity",
+    "write_statistics",
+    "write_fitness",
+    "write_sequence",
+    "write_alleles",
+    "write_diversity",
+    "write_sites",
+    "write_delta",
+    "write_sketch",
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<unsigned int>(Phase::size_), "");
+
+constexpr const char* EVENT_NAMES[] = {
+    "attempts",
+    "acceptances",
+    "transposons",
+    "transpositions",
+    "excisions",
+    "mutations",
+    "gp_insertions",
+    "migrations",
+};
+static_assert(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == static_cast<unsigned int>(Event::size_), "");
+
+std::mutex MTX;
+Profile TOTAL;
+}
+
+bool Profile::ENABLED_ = false;
+
+Profile& Profile::operator+=(const Profile& other) noexcept {
+    for (size_t i=0u; i<wall_ns_.size(); ++i) {
+        wall_ns_[i] += other.wall_ns_[i];
+        cpu_ns_[i] += other.cpu_ns_[i];
+    }
+    for (size_t i=0u; i<events_.size(); ++i) {
+        events_[i] += other.events_[i];
+    }
+    for (size_t i=0u; i<counters_.size(); ++i) {
+        for (size_t j=0u; j<counters_[i].size(); ++j) {
+            counters_[i][j] += other.counters_[i][j];
+        }
+    }
+    return *this;
+}
+
+void Profile::merge() {
+    if (!enabled()) return;
+    auto& x = local();
+    {
+        std::lock_guard<std::mutex> lock(MTX);
+        TOTAL += x;
+    }
+    x = Profile();
+}
+
+Profile Profile::take() {
+    std::lock_guard<std::mutex> lock(MTX);
+    Profile x = TOTAL;
+    TOTAL = Profile();
+    return x;
+}
+
+bool Profile::empty() const noexcept {
+    auto is_zero = [](uint_fast64_t x) {return x == 0u;};
+    return std::all_of(wall_ns_.begin(), wall_ns_.end(), is_zero)
+        && std::all_of(cpu_ns_.begin(), cpu_ns_.end(), is_zero)
+        && std::all_of(events_.begin(), events_.end(), is_zero);
+}
+
+std::ostream& Profile::write_header(std::ostream& ost) {
+    ost << "generation";
+    for (const char* name: PHASE_NAMES) {
+        ost << "\t" << name << "_wall\t" << name << "_cpu";
+    }
+    for (const char* name: EVENT_NAMES) {
+        ost << "\t" << name;
+    }
+    return ost << "\n";
+}
+
+std::string Profile::header() {
+    std::ostringstream oss;
+    write_header(oss);
+    return oss.str();
+}
+
+std::ostream& Profile::write(std::ostream& ost, const size_t generation) const {
+    constexpr double over_ns = 1e-9;
+    ost << generation;
+    for (size_t i=0u; i<wall_ns_.size(); ++i) {
+        ost << "\t" << wall_ns_[i] * over_ns << "\t" << cpu_ns_[i] * over_ns;
+    }
+    for (const auto n: events_) {
+        ost << "\t" << n;
+    }
+    return ost << "\n";
+}
+
+std::ostream& Profile::write_counters(std::ostream& ost) const {
+    constexpr unsigned int num_counters = static_cast<unsigned int>(Counter::size_);
+    ost << "phase";
+    for (unsigned int j=0u; j<num_counters; ++j) {
+        ost << "\t" << PerfCounters::name(static_cast<Counter>(j));
+    }
+    ost << "\n";
+    for (size_t i=0u; i<counters_.size(); ++i) {
+        ost << PHASE_NAMES[i];
+        for (unsigned int j=0u; j<num_counters; ++j) {
+            if (PerfCounters::available(static_cast<Counter>(j))) {
+                ost << "\t" << counters_[i][j];
+            } else {
+                ost << "\tNA";
+            }
+        }
+        ost << "\n";
+    }
+    return ost;
+}
+
+} // namespace tek
@@ -0,0 +1,186 @@
+/*! @file profile.hpp
+    @brief Interface of Profile class
+*/
+#pragma once
+#ifndef TEK_PROFILE_HPP_
+#define TEK_PROFILE_HPP_
+
+#include "perf.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <string>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+//! phases timed by Stopwatch
+enum class Phase: unsigned int {
+    sampling,
+    gametogenesis,
+    fitness,
+    transpose_mutate,
+    //! hyperactivation, claiming a slot, census, and moving offspring into it
+    store_offspring,
+    statistics,
+    species_distance,
+    simplify,
+    diversity,
+    site_frequency,
+    snapshot,
+    write_activity,
+    write_statistics,
+    write_fitness,
+    write_sequence,
+    write_alleles,
+    write_diversity,
+    write_sites,
+    write_delta,
+    write_sketch,
+    size_
+};
+
+//! events counted by Profile::count()
+enum class Event: unsigned int {
+    attempt,
+    acceptance,
+    transposon,
+    transposition,
+    excision,
+    mutation,
+    gp_insertion,
+    migration,
+    size_
+};
+
+/*! @brief Wall/CPU time per phase and event counts
+
+    Each thread accumulates into its own local() object,
+    which is merged into a global total by merge().
+    Hardware counters per phase are added if PerfCounters::enabled().
+    Everything is a no-op unless compiled with TEK_PROFILE
+    and switched on by enabled(true).
+*/
+class Profile {
+  public:
+    //! add time to a phase
+    void add(Phase phase, uint_fast64_t wall_ns, uint_fast64_t cpu_ns) noexcept {
+        const auto i = static_cast<unsigned int>(phase);
+        wall_ns_[i] += wall_ns;
+        cpu_ns_[i] += cpu_ns;
+    }
+    //! add differences of hardware counters to a phase
+    void add(Phase phase, const PerfCounters::value_type& after, const PerfCounters::value_type& before) noexcept {
+        auto& x = counters_[static_cast<unsigned int>(phase)];
+        for (size_t i=0u; i<x.size(); ++i) {
+            x[i] += after[i] - before[i];
+        }
+    }
+    //! merge
+    Profile& operator+=(const Profile& other) noexcept;
+    //! write a row of profile.tsv
+    std::ostream& write(std::ostream&, size_t generation) const;
+    //! write header of profile.tsv
+    static std::ostream& write_header(std::ostream&);
+    //! header of profile.tsv as a string
+    static std::string header();
+    //! true if nothing has been added
+    bool empty() const noexcept;
+    //! write hardware counters per phase as perf.tsv
+    std::ostream& write_counters(std::ostream&) const;
+
+    //! count events in this thread
+    static void count(Event event, uint_fast64_t n = 1u) noexcept {
+#ifdef TEK_PROFILE
+        if (!ENABLED_) return;
+        local().events_[static_cast<unsigned int>(event)] += n;
+#else
+        static_cast<void>(event);
+        static_cast<void>(n);
+#endif
+    }
+    //! merge local() into the global total and clear local()
+    static void merge();
+    //! return the global total and clear it
+    static Profile take();
+    //! object for this thread
+    static Profile& local() noexcept {
+        thread_local Profile x;
+        return x;
+    }
+    //! run-time switch
+    static void enabled(bool x) noexcept {ENABLED_ = x;}
+    //! true if compiled with TEK_PROFILE and switched on
+    static bool enabled() noexcept {
+#ifdef TEK_PROFILE
+        return ENABLED_;
+#else
+        return false;
+#endif
+    }
+
+  private:
+    //! run-time switch
+    static bool ENABLED_;
+
+    //! wall-clock time per phase
+    std::array<uint_fast64_t, static_cast<unsigned int>(Phase::size_)> wall_ns_ = {};
+    //! CPU time of the thread per phase
+    std::array<uint_fast64_t, static_cast<unsigned int>(Phase::size_)> cpu_ns_ = {};
+    //! counts per event
+    std::array<uint_fast64_t, static_cast<unsigned int>(Event::size_)> events_ = {};
+    //! hardware counters per phase
+    std::array<PerfCounters::value_type, static_cast<unsigned int>(Phase::size_)> counters_ = {};
+};
+
+/*! @brief Measure time between laps and add it to Profile::local()
+*/
+class Stopwatch {
+  public:
+    //! start
+    Stopwatch() noexcept {
+        if (!Profile::enabled()) return;
+        now(&wall_, &cpu_);
+        if (PerfCounters::enabled()) PerfCounters::read(&counters_);
+    }
+    //! add time since construction or the last lap to the phase
+    void lap(Phase phase) noexcept {
+        if (!Profile::enabled()) return;
+        uint_fast64_t wall = 0u, cpu = 0u;
+        now(&wall, &cpu);
+        Profile::local().add(phase, wall - wall_, cpu - cpu_);
+        wall_ = wall;
+        cpu_ = cpu;
+        if (PerfCounters::enabled()) {
+            PerfCounters::value_type counters;
+            PerfCounters::read(&counters);
+            Profile::local().add(phase, counters, counters_);
+            counters_ = counters;
+        }
+    }
+
+  private:
+    //! get current time in nanoseconds
+    static void now(uint_fast64_t* wall, uint_fast64_t* cpu) noexcept {
+        using namespace std::chrono;
+        *wall = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        timespec ts;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        *cpu = static_cast<uint_fast64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+    }
+
+    //! wall-clock time at the last lap
+    uint_fast64_t wall_ = 0u;
+    //! CPU time at the last lap
+    uint_fast64_t cpu_ = 0u;
+    //! hardware counters at the last lap
+    PerfCounters::value_type counters_ = {};
+};
+
+} // namespace tek
+
+#endif /* TEK_PROFILE_HPP_ */
@@ -7,6 +7,10 @@
 #include "population.hpp"
 #include "haploid.hpp"
 #include "transposon.hpp"
+#include "column.hpp"
+#include "profile.hpp"
+#include "metrics.hpp"
+#include "bgzf.hpp"
 
 #include <wtl/exception.hpp>
 #include <wtl/debug.hpp>
@@ -16,8 +20,16 @@
 #include <wtl/filesystem.hpp>
 #include <clippson/clippson.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+
 namespace tek {
 
+inline namespace TEK_LENGTH_NAMESPACE {
+
 //! variables map
 nlohmann::json VM;
 
@@ -41,6 +53,12 @@ inline clipp::group general_options(nlohmann::json* vm) {HERE;
     `-i,--interval`     |         |
     `-r,--record`       |         |
     `-o,--outdir`       |         |
+    `--length`          | \f$L\f$ | LENGTH
+    `--load`            |         |
+    `--save`            |         |
+    `--profile`         |         | Profile::enabled()
+    `--perf`            |         | PerfCounters::enabled()
+    `--metrics`         |         | Metrics::enabled()
 */
 inline clipp::group program_options(nlohmann::json* vm) {HERE;
     const std::string outdir = wtl::strftime("tek_%Y%m%d_%H%M%S");
@@ -60,6 +78,18 @@ inline clipp::group program_options(nlohmann::json* vm) {HERE;
       wtl::option(vm, {"r", "record"}, 3,
         "enum Recording"),
       wtl::option(vm, {"o", "outdir"}, outdir),
+      wtl::option(vm, {"length"}, static_cast<unsigned int>(LENGTH),
+        "sequence length of TE; one of the lengths compiled in"),
+      wtl::option(vm, {"load"}, std::string{},
+        "start from a snapshot of the same --popsize instead of founders"),
+      wtl::option(vm, {"save"}, std::string{},
+        "write a snapshot to this file in outdir at the end"),
+      wtl::option(vm, {"profile"}, false,
+        "write time per phase and event counts to profile.tsv, and of writing to profile_writers.tsv.gz"),
+      wtl::option(vm, {"perf"}, false,
+        "write hardware counters per phase to perf.tsv; implies --profile"),
+      wtl::option(vm, {"metrics"}, false,
+        "publish live metrics in /dev/shm/tek2.<pid> for tek2-top"),
       wtl::option(vm, {"seed"}, seed)
     ).doc("Program:");
 }
@@ -71,13 +101,46 @@ inline clipp::group program_options(nlohmann::json* vm) {HERE;
     `--sample`          |               | PopulationParams::SAMPLE_SIZE
     `-j,--parallel`     |               | PopulationParams::CONCURRENCY
     `-c,--coexist`      |               | PopulationParams::MAX_COEXISTENCE
+    `--memory-budget`   |               | PopulationParams::MEMORY_BUDGET
+    `--checkpoint`      |               | PopulationParams::CHECKPOINT
+    `--demes`           | \f$K\f$       | PopulationParams::NUM_DEMES
+    `-m,--migration`    | \f$m\f$       | PopulationParams::MIGRATION_RATE
+    `--diversity-alleles` |             | PopulationParams::DIVERSITY_ALLELES
+    `--top-sites`       |               | PopulationParams::TOP_SITES
+    `--establish-copies` |              | PopulationParams::ESTABLISH_COPIES
+    `--establish-generations` |         | PopulationParams::ESTABLISH_GENERATIONS
+    `--establish-attempts` |            | PopulationParams::ESTABLISH_ATTEMPTS
+    `--stop-inactive`   |               | PopulationParams::STOP_INACTIVE
+    `--batch`           |               | PopulationParams::BATCH_SIZE
 */
 inline clipp::group
 population_options(nlohmann::json* vm, PopulationParams* p) {HERE;
     return (
       wtl::option(vm, {"sample"}, &p->SAMPLE_SIZE),
       wtl::option(vm, {"j", "parallel"}, &p->CONCURRENCY),
-      wtl::option(vm, {"c", "coexist"}, &p->MAX_COEXISTENCE)
+      wtl::option(vm, {"c", "coexist"}, &p->MAX_COEXISTENCE),
+      wtl::option(vm, {"memory-budget"}, &p->MEMORY_BUDGET,
+        "warn when resident memory exceeds this MiB"),
+      wtl::option(vm, {"checkpoint"}, &p->CHECKPOINT,
+        "save a snapshot when --memory-budget is exceeded"),
+      wtl::option(vm, {"demes"}, &p->NUM_DEMES,
+        "number of demes in the island model"),
+      wtl::option(vm, {"m", "migration"}, &p->MIGRATION_RATE,
+        "probability that an offspring migrates to another deme"),
+      wtl::option(vm, {"diversity-alleles"}, &p->DIVERSITY_ALLELES,
+        "max number of unique alleles compared pairwise for --record=512"),
+      wtl::option(vm, {"top-sites"}, &p->TOP_SITES,
+        "number of the most frequent insertion sites written for --record=1024"),
+      wtl::option(vm, {"establish-copies"}, &p->ESTABLISH_COPIES,
+        "run attempts in parallel until one has this many TEs; 0 to disable"),
+      wtl::option(vm, {"establish-generations"}, &p->ESTABLISH_GENERATIONS,
+        "regard an attempt surviving this many generations as established"),
+      wtl::option(vm, {"establish-attempts"}, &p->ESTABLISH_ATTEMPTS,
+        "max number of establishment attempts before starting over"),
+      wtl::option(vm, {"stop-inactive"}, &p->STOP_INACTIVE,
+        "start over as soon as no active TE remains"),
+      wtl::option(vm, {"batch"}, &p->BATCH_SIZE,
+        "evaluate this many candidates together per thread; 0 for one at a time")
     ).doc("Population:");
 }
 
@@ -147,6 +210,10 @@ Program::Program(const std::vector<std::string>& arguments) {HERE;
         std::cout << PROJECT_VERSION << "\n";
         throw wtl::ExitSuccess();
     }
+    const unsigned int length = VM.at("length");
+    if (length != LENGTH) {
+        throw std::runtime_error("--length does not match the compiled LENGTH");
+    }
     Population::param(population_params);
     Haploid::param(haploid_params);
     Transposon::param(transposon_params);
@@ -175,20 +242,73 @@ void Program::main() {HERE;
     const int record_flags_ = VM.at("record");
     const std::string outdir_ = VM.at("outdir");
     Population::seed(VM.at("seed"));
+    const bool profile = VM.at("profile");
+    const bool perf = VM.at("perf");
+    PerfCounters::enabled(perf);
+    Profile::enabled(profile || perf);
+    const std::string load_ = VM.at("load");
+    const std::string save_ = VM.at("save");
+    std::string snapshot;
+    if (!load_.empty()) {
+        wtl::zlib::ifstream ist(load_);
+        snapshot.assign(std::istreambuf_iterator<char>(ist), std::istreambuf_iterator<char>());
+        if (snapshot.empty()) throw std::runtime_error("failed to read " + load_);
+        std::istringstream iss(snapshot);
+        const size_t loaded_size = Population(iss).gametes().size() / 2u;
+        if (loaded_size != popsize_) {
+            throw std::runtime_error("--popsize " + std::to_string(popsize_) + " does not match "
+                                     + std::to_string(loaded_size) + " individuals in " + load_);
+        }
+    }
+    auto make_population = [&]() {
+        if (snapshot.empty()) return Population(popsize_, initial_freq_);
+        std::istringstream iss(snapshot);
+        return Population(iss);
+    };
     wtl::ChDir cd_outdir(outdir_, true);
+    std::unique_ptr<Metrics> metrics;
+    if (VM.at("metrics")) metrics = std::make_unique<Metrics>();
+    size_t establish_generations = std::min(Population::param().ESTABLISH_GENERATIONS, num_generations_);
+    if (hyperactivate > 0u) {
+        // hyperactivation must happen in evolve()
+        establish_generations = std::min(establish_generations, hyperactivate - 1u);
+    }
+    const bool establish = (Population::param().ESTABLISH_COPIES > 0u && snapshot.empty()
+                            && establish_generations > 0u);
     while (true) {
-        Population pop(popsize_, initial_freq_);
+        Population pop = make_population();
+        size_t first_generation = 1u;
+        if (establish) {
+            const Establishment est = pop.establish(establish_generations);
+            if (est.generations == 0u) continue;
+            first_generation += est.generations;
+            auto ofs = wtl::make_ofs("establishment.json");
+            ofs << "{\"attempt\": " << est.attempt
+                << ", \"seed\": " << est.seed
+                << ", \"generations\": " << est.generations
+                << ", \"copies\": " << est.copies << "}\n";
+        }
         auto flags = static_cast<Recording>(record_flags_);
-        bool good = pop.evolve(num_generations_, record_interval_, flags, hyperactivate);
+        bool good = pop.evolve(num_generations_, record_interval_, flags, hyperactivate, first_generation);
         if (!good) continue;
         wtl::make_ofs("config.json") << config_;
+        if (!save_.empty()) {
+            BgzfStream ost(save_);
+            pop.save(ost);
+        }
         if (static_cast<bool>(flags & Recording::sequence)) {
-            wtl::zlib::ofstream ost("sequence.fa.gz");
+            BgzfStream ost("sequence.fa.gz");
             pop.write_fasta(ost);
         }
         if (static_cast<bool>(flags & Recording::summary)) {
-            wtl::zlib::ofstream ost("summary.json.gz");
-            pop.write_summary(ost);
+            if (static_cast<bool>(flags & Recording::columnar)) {
+                ColumnWriter table("summary.tekc", Population::summary_columns());
+                pop.write_summary(table, num_generations_);
+                table.close();
+            } else {
+                BgzfStream ost("summary.json.gz");
+                pop.write_summary(ost);
+            }
         }
         if (num_generations_after_split_ == 0u) break;
         Population pop2(pop);
@@ -206,4 +326,15 @@ void Program::main() {HERE;
     }
 }
 
+int launch(int argc, char* argv[]) {
+    try {
+        Program program(argc, argv);
+        program.run();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "\nruntime_error: " << e.what() << std::endl;
+    }
+    return 0;
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
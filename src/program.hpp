@@ -5,11 +5,15 @@
 #ifndef TEK_PROGRAM_HPP_
 #define TEK_PROGRAM_HPP_
 
+#include "length.hpp"
+
 #include <vector>
 #include <string>
 
 namespace tek {
 
+inline namespace TEK_LENGTH_NAMESPACE {
+
 /*! @brief Program class
 */
 class Program {
@@ -31,6 +35,10 @@ class Program {
     std::string config_;
 };
 
+//! Instantiate and run Program compiled for LENGTH; called from global main
+int launch(int argc, char* argv[]);
+
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
 
 #endif /* TEK_PROGRAM_HPP_ */
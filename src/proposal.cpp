@@ -0,0 +1,121 @@
+/*! @file proposal.cpp
+    @brief Implementation of GameteTable class
+*/
+#include "proposal.hpp"
+#include "transposon.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+GameteTable::GameteTable(const std::vector<Haploid>& gametes)
+: gametes_(gametes), offsets_(gametes.size() + 1u, 0u) {
+    for (size_t g=0u; g<gametes.size(); ++g) {
+        offsets_[g + 1u] = offsets_[g] + gametes[g].size();
+    }
+    positions_.resize(offsets_.back());
+    factors_.resize(offsets_.back());
+    species_.resize(offsets_.back());
+}
+
+void GameteTable::fill(const size_t begin, const size_t end) {
+    const auto& coefs = Haploid::coefs_gp();
+    std::shared_lock<std::shared_timed_mutex> lock(Haploid::MTX_);
+    for (size_t g=begin; g<end; ++g) {
+        size_t k = offsets_[g];
+        for (const auto& p: gametes_[g].sites_) {
+            positions_[k] = p.first;
+            factors_[k] = 1.0 - coefs.at(p.first);
+            species_[k] = p.second->species();
+            ++k;
+        }
+    }
+}
+
+template <class Visit> inline
+void GameteTable::walk(const size_t i, bool flg, const position_t* xit, Visit&& visit) const {
+    // same merge as Haploid::gametogenesis() from the first chromosome
+    constexpr position_t max_pos = std::numeric_limits<position_t>::max();
+    size_t first = offsets_[2u * i];
+    const size_t first_end = offsets_[2u * i + 1u];
+    size_t second = first_end;
+    const size_t second_end = offsets_[2u * i + 2u];
+    position_t first_pos = (first < first_end) ? positions_[first] : max_pos;
+    position_t second_pos = (second < second_end) ? positions_[second] : max_pos;
+    position_t here = 0;
+    while ((here = std::min(first_pos, second_pos)) < max_pos) {
+        while (*xit < here) {
+            flg = !flg;
+            ++xit;
+        }
+        if (first_pos < second_pos) {
+            if (!flg) visit(first);
+            ++first;
+            first_pos = (first < first_end) ? positions_[first] : max_pos;
+        } else if (first_pos == second_pos) {
+            visit(flg ? second : first);
+            ++first;
+            ++second;
+            first_pos = (first < first_end) ? positions_[first] : max_pos;
+            second_pos = (second < second_end) ? positions_[second] : max_pos;
+        } else {
+            if (flg) visit(second);
+            ++second;
+            second_pos = (second < second_end) ? positions_[second] : max_pos;
+        }
+    }
+}
+
+template <>
+double GameteTable::fitness<false>(const Proposal& x, const std::vector<position_t>& chiasmata) const {
+    // products in the order of sites as in Haploid::prod_1_zs()
+    double egg_product = 1.0;
+    double sperm_product = 1.0;
+    uint_fast32_t copy_number = 0u;
+    walk(x.mother, x.egg_flg, &chiasmata[x.egg_chiasmata], [&](size_t k) {
+        egg_product *= factors_[k];
+        ++copy_number;
+    });
+    walk(x.father, x.sperm_flg, &chiasmata[x.sperm_chiasmata], [&](size_t k) {
+        sperm_product *= factors_[k];
+        ++copy_number;
+    });
+    return std::max(egg_product * sperm_product * Haploid::prod_1_xi_n_tau(copy_number), 0.0);
+}
+
+template <>
+double GameteTable::fitness<true>(const Proposal& x, const std::vector<position_t>& chiasmata) const {
+    // (species, copy number) in order of appearance as in Haploid::fitness<true>()
+    thread_local std::vector<std::pair<uint_fast32_t, uint_fast32_t>> counter;
+    counter.clear();
+    auto count = [this](size_t k) {
+        const uint_fast32_t species = species_[k];
+        auto it = std::find_if(counter.begin(), counter.end(), [species](const auto& p) {
+            return p.first == species;
+        });
+        if (it == counter.end()) {
+            counter.emplace_back(species, 1u);
+        } else {
+            ++it->second;
+        }
+    };
+    double egg_product = 1.0;
+    double sperm_product = 1.0;
+    walk(x.mother, x.egg_flg, &chiasmata[x.egg_chiasmata], [&](size_t k) {
+        egg_product *= factors_[k];
+        count(k);
+    });
+    walk(x.father, x.sperm_flg, &chiasmata[x.sperm_chiasmata], [&](size_t k) {
+        sperm_product *= factors_[k];
+        count(k);
+    });
+    return std::max(egg_product * sperm_product * Haploid::prod_1_xi_n_tau(counter), 0.0);
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
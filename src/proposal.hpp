@@ -0,0 +1,80 @@
+/*! @file proposal.hpp
+    @brief Interface of GameteTable class
+*/
+#pragma once
+#ifndef TEK_PROPOSAL_HPP_
+#define TEK_PROPOSAL_HPP_
+
+#include "haploid.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+//! @brief Candidate zygote drawn by Population::step() before it is built
+struct Proposal {
+    //! index of the mother individual
+    size_t mother = 0u;
+    //! index of the father individual
+    size_t father = 0u;
+    //! offset of the egg chiasmata in the buffer of the batch
+    uint32_t egg_chiasmata = 0u;
+    //! offset of the sperm chiasmata in the buffer of the batch
+    uint32_t sperm_chiasmata = 0u;
+    //! the egg starts from the second chromosome
+    bool egg_flg = false;
+    //! the sperm starts from the second chromosome
+    bool sperm_flg = false;
+};
+
+/*! @brief Positions, GP factors, and species of TEs in parent gametes
+
+    TEs of all the gametes are copied into flat arrays once per generation,
+    so that fitness() of a Proposal walks the parent sites
+    without building the gametes or looking up Haploid::SELECTION_COEFS_GP().
+    The result is identical to Haploid::fitness() of the gametes
+    built by Haploid::gametogenesis() with the same chiasmata.
+*/
+class GameteTable {
+  public:
+    //! alias
+    using position_t = Haploid::position_t;
+
+    //! allocate arrays for the gametes; call fill() to copy TEs
+    explicit GameteTable(const std::vector<Haploid>& gametes);
+    //! copy TEs of the gametes [begin, end); disjoint ranges can be filled in parallel
+    void fill(size_t begin, size_t end);
+
+    //! fitness of the zygote; `chiasmata` is the buffer of the batch
+    template <bool Speciation>
+    double fitness(const Proposal&, const std::vector<position_t>& chiasmata) const;
+
+  private:
+    //! call `visit(k)` for each TE k in the gamete recombined from individual `i`
+    template <class Visit>
+    void walk(size_t i, bool flg, const position_t* chiasmata, Visit&& visit) const;
+
+    //! gametes of the parent generation
+    const std::vector<Haploid>& gametes_;
+    //! TEs of gamete g are [offsets_[g], offsets_[g + 1])
+    std::vector<size_t> offsets_;
+    //! sorted positions within each gamete
+    std::vector<position_t> positions_;
+    //! \f$1 - s_{GP}\f$ of each TE
+    std::vector<double> factors_;
+    //! species of each TE
+    std::vector<uint_fast32_t> species_;
+};
+
+template <> double GameteTable::fitness<true>(const Proposal&, const std::vector<Haploid::position_t>&) const;
+template <> double GameteTable::fitness<false>(const Proposal&, const std::vector<Haploid::position_t>&) const;
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_PROPOSAL_HPP_ */
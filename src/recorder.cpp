@@ -0,0 +1,99 @@
+/*! @file recorder.cpp
+    @brief Implementation of Recorder class
+*/
+#include "recorder.hpp"
+#include "bgzf.hpp"
+#include "column.hpp"
+
+#include <wtl/concurrent.hpp>
+
+namespace tek {
+
+Recorder::Recorder(const size_t capacity, const unsigned int compression_threads)
+: capacity_(capacity),
+  compressors_(compression_threads > 0u ? std::make_unique<wtl::ThreadPool>(compression_threads) : nullptr),
+  thread_(&Recorder::run, this) {}
+
+Recorder::~Recorder() {
+    try {
+        close();
+    } catch (...) {}  // already reported by push() or close() if called
+}
+
+void Recorder::push(job_type&& job) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_push_.wait(lock, [this] {
+        return queue_.size() < capacity_ || exception_;
+    });
+    if (exception_) std::rethrow_exception(exception_);
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    cv_pop_.notify_one();
+}
+
+void Recorder::close() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closing_ = true;
+    }
+    cv_pop_.notify_one();
+    thread_.join();
+    if (exception_) std::rethrow_exception(exception_);
+}
+
+std::ostream& Recorder::stream(const std::string& filename, const std::string& header) {
+    auto& ptr = streams_[filename];
+    if (!ptr) {
+        ptr = std::make_unique<BgzfStream>(filename, compressors_.get());
+        *ptr << header;
+    }
+    ptr->mark(key_);
+    return *ptr;
+}
+
+std::unique_ptr<BgzfStream> Recorder::open(const std::string& filename) {
+    return std::make_unique<BgzfStream>(filename, compressors_.get());
+}
+
+ColumnWriter& Recorder::table(const std::string& filename, const std::vector<ColumnSpec>& columns) {
+    auto& ptr = tables_[filename];
+    if (!ptr) {
+        ptr = std::make_unique<ColumnWriter>(filename, columns);
+    }
+    return *ptr;
+}
+
+void Recorder::run() {
+    while (true) {
+        job_type job;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_pop_.wait(lock, [this] {return closing_ || !queue_.empty();});
+            if (queue_.empty()) break;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        cv_push_.notify_one();
+        try {
+            job(*this);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            exception_ = std::current_exception();
+            queue_.clear();
+            cv_push_.notify_all();
+            break;
+        }
+    }
+    try {
+        for (auto& p: streams_) p.second->close();
+        streams_.clear();
+        for (auto& p: tables_) p.second->close();
+        tables_.clear();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!exception_) exception_ = std::current_exception();
+    }
+}
+
+} // namespace tek
@@ -0,0 +1,99 @@
+/*! @file recorder.hpp
+    @brief Interface of Recorder class
+*/
+#pragma once
+#ifndef TEK_RECORDER_HPP_
+#define TEK_RECORDER_HPP_
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace wtl {
+class ThreadPool;
+}
+
+namespace tek {
+
+class BgzfStream;
+class ColumnWriter;
+struct ColumnSpec;
+
+/*! @brief Background writer of periodic records
+
+    Jobs are executed in order on a dedicated thread.
+    Each job should own a snapshot of the data it writes.
+    push() blocks while the queue is full.
+    Streams are compressed in BGZF blocks on `compression_threads` threads,
+    and indexed by the key of the last mark().
+*/
+class Recorder {
+  public:
+    //! function to be executed on the writer thread
+    using job_type = std::function<void(Recorder&)>;
+
+    //! constructor; start the writer thread
+    explicit Recorder(size_t capacity = 4u, unsigned int compression_threads = 0u);
+    //! destructor; finish remaining jobs
+    ~Recorder();
+    //! noncopyable
+    Recorder(const Recorder&) = delete;
+
+    //! add a job to the queue; rethrow an exception from the writer
+    void push(job_type&& job);
+    //! finish remaining jobs, close streams, and join the writer thread
+    void close();
+
+    //! return a compressed stream kept open until close(); called from jobs
+    std::ostream& stream(const std::string& filename, const std::string& header = "");
+    //! return a compressed stream to be closed by the caller; called from jobs
+    std::unique_ptr<BgzfStream> open(const std::string& filename);
+    //! set the key of index entries for subsequent stream() calls; called from jobs
+    void mark(uint64_t key) noexcept {key_ = key;}
+    //! return a columnar writer kept open until close(); called from jobs
+    ColumnWriter& table(const std::string& filename, const std::vector<ColumnSpec>& columns);
+
+  private:
+    //! main loop of the writer thread
+    void run();
+
+    //! max number of jobs waiting in #queue_
+    const size_t capacity_;
+    //! threads to compress blocks; nullptr to compress on the writer thread
+    std::unique_ptr<wtl::ThreadPool> compressors_;
+    //! key set by mark()
+    uint64_t key_ = 0u;
+    //! filename => open stream
+    std::map<std::string, std::unique_ptr<BgzfStream>> streams_;
+    //! filename => open columnar writer
+    std::map<std::string, std::unique_ptr<ColumnWriter>> tables_;
+    //! jobs waiting to be executed
+    std::deque<job_type> queue_;
+    //! lock for #queue_ and #exception_
+    std::mutex mtx_;
+    //! notified when a job is taken from #queue_
+    std::condition_variable cv_push_;
+    //! notified when a job is added to #queue_
+    std::condition_variable cv_pop_;
+    //! set by close()
+    bool closing_ = false;
+    //! the first exception thrown by a job
+    std::exception_ptr exception_;
+    //! writer thread; declared last to be started last
+    std::thread thread_;
+};
+
+} // namespace tek
+
+#endif /* TEK_RECORDER_HPP_ */
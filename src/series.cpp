@@ -0,0 +1,106 @@
+/*! @file series.cpp
+    @brief Implementation of AlleleSeries class
+*/
+#include "series.hpp"
+
+#include <ostream>
+#include <map>
+#include <unordered_set>
+#include <limits>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+namespace {
+
+//! write 1-based positions and bases of `child` that differ from `parent`
+void write_changes(std::ostream& ost, const Transposon& parent, const Transposon& child) {
+    char x[LENGTH];
+    char y[LENGTH];
+    parent.encode_sequence(x);
+    child.encode_sequence(y);
+    const char* delimiter = "";
+    for (size_t i=0u; i<LENGTH; ++i) {
+        if (x[i] != y[i]) {
+            ost << delimiter << i + 1u << y[i];
+            delimiter = ",";
+        }
+    }
+}
+
+}
+
+const char* AlleleSeries::alleles_header() noexcept {
+    return "generation\tallele\tparent\tspecies\tindel\thyperactive\tdn\tds\tactivity\tchanges\n";
+}
+
+const char* AlleleSeries::copies_header() noexcept {
+    return "generation\tindividual\tallele\tcopy_number\n";
+}
+
+void AlleleSeries::write_new(std::ostream& ost, const size_t time, const uint_fast64_t id, const Transposon& te,
+                             const record_type& candidates) const {
+    const std::pair<Transposon, uint_fast64_t>* parent = nullptr;
+    uint_fast32_t min_distance = std::numeric_limits<uint_fast32_t>::max();
+    for (const auto& p: candidates) {
+        const auto distance = (p.first - te);
+        if (distance < min_distance) {
+            min_distance = distance;
+            parent = &p;
+        }
+    }
+    ost << time << "\t" << id << "\t";
+    if (parent) {
+        ost << parent->second;
+    } else {
+        ost << "NA";
+    }
+    ost << "\t" << te.species() << "\t" << te.has_indel() << "\t" << te.is_hyperactive()
+        << "\t" << te.dn() << "\t" << te.ds() << "\t" << te.activity() << "\t";
+    write_changes(ost, parent ? parent->first : Transposon(), te);
+    ost << "\n";
+}
+
+void AlleleSeries::write(std::ostream& alleles_out, std::ostream& copies_out, const size_t time,
+                         const std::vector<Transposon>& alleles,
+                         const std::vector<individual_type>& individuals) {
+    // parents are searched in recent records and new alleles written before
+    record_type candidates;
+    std::unordered_set<uint_fast64_t> candidate_ids;
+    for (auto it = recent_.rbegin(); it != recent_.rend(); ++it) {
+        for (const auto& p: *it) {
+            if (candidate_ids.insert(p.second).second) candidates.push_back(p);
+        }
+    }
+    std::unordered_set<uint_fast64_t> current_ids;
+    record_type current;
+    std::vector<uint_fast64_t> ids(alleles.size());
+    for (size_t k=0u; k<alleles.size(); ++k) {
+        const auto& te = alleles[k];
+        auto it = ids_.find(te);
+        if (it == ids_.end()) {
+            it = ids_.emplace(te, next_id_++).first;
+            write_new(alleles_out, time, it->second, te, candidates);
+            candidates.emplace_back(te, it->second);
+        }
+        if (current_ids.insert(it->second).second) {
+            current.emplace_back(te, it->second);
+        }
+        ids[k] = it->second;
+    }
+    recent_.push_back(std::move(current));
+    if (recent_.size() > NUM_RECENT) recent_.pop_front();
+    for (size_t i=0u; i<individuals.size(); ++i) {
+        std::map<uint_fast64_t, unsigned int> counter;
+        for (const auto& p: individuals[i]) {
+            counter[ids[p.first]] += p.second;
+        }
+        for (const auto& p: counter) {
+            copies_out << time << "\t" << i << "\t" << p.first << "\t" << p.second << "\n";
+        }
+    }
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
@@ -0,0 +1,75 @@
+/*! @file series.hpp
+    @brief Interface of AlleleSeries class
+*/
+#pragma once
+#ifndef TEK_SERIES_HPP_
+#define TEK_SERIES_HPP_
+
+#include "transposon.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+/*! @brief Time series of sampled alleles written as differences
+
+    Each allele is written once when it first appears,
+    and keeps its ID when it is sampled again after any number of records.
+    Its parent is the closest allele among the last #NUM_RECENT records
+    and the new alleles written before it in the same record;
+    the row holds the sites that differ from the parent.
+    Alleles without parent differ from the original TE of all 'A'.
+    Copy numbers per individual refer to allele IDs.
+    An instance keeps the IDs of all the alleles written so far,
+    and should be used from a single thread, e.g., the Recorder thread.
+*/
+class AlleleSeries {
+  public:
+    //! TE copies in an individual: (index in alleles, copy number)
+    using individual_type = std::vector<std::pair<size_t, unsigned int>>;
+
+    //! write new alleles and copy numbers of a sample at `time`
+    void write(std::ostream& alleles_out, std::ostream& copies_out, size_t time,
+               const std::vector<Transposon>& alleles,
+               const std::vector<individual_type>& individuals);
+    //! header for alleles_out of write()
+    static const char* alleles_header() noexcept;
+    //! header for copies_out of write()
+    static const char* copies_header() noexcept;
+
+    //! number of records searched for parents
+    static constexpr size_t NUM_RECENT = 4u;
+
+  private:
+    //! hash of Transposon for #ids_
+    struct Hash {
+        size_t operator()(const Transposon& x) const noexcept {return x.hash();}
+    };
+    //! (allele, ID) pairs
+    using record_type = std::vector<std::pair<Transposon, uint_fast64_t>>;
+
+    //! write a row of a new allele with its closest allele in `candidates`
+    void write_new(std::ostream&, size_t time, uint_fast64_t id, const Transposon&,
+                   const record_type& candidates) const;
+
+    //! IDs of all the alleles written so far
+    std::unordered_map<Transposon, uint_fast64_t, Hash> ids_;
+    //! distinct alleles of the last #NUM_RECENT records
+    std::deque<record_type> recent_;
+    //! ID of the next new allele
+    uint_fast64_t next_id_ = 0u;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_SERIES_HPP_ */
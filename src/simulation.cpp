@@ -0,0 +1,81 @@
+/*! @file simulation.cpp
+    @brief Implementation of Simulation class
+*/
+#include "simulation.hpp"
+#include "statistics.hpp"
+#include "genealogy.hpp"
+#include "profile.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+Observation::~Observation() = default;
+
+const Statistics& Observation::statistics() const {
+    if (!statistics_) {
+        statistics_ = std::make_unique<Statistics>(population_.collect_statistics(false));
+    }
+    return *statistics_;
+}
+
+const SimulationParams& Simulation::configure(const SimulationParams& params) {
+    if (params.SPECIES_INTERVAL == 0u) {
+        throw std::invalid_argument("SPECIES_INTERVAL must be positive");
+    }
+    Population::param(params.POPULATION);
+    Haploid::param(params.HAPLOID);
+    Transposon::param(params.TRANSPOSON);
+    Population::seed(params.SEED);
+    Genealogy::clear();
+    Genealogy::enabled(false);
+    return params;
+}
+
+Simulation::Simulation(const SimulationParams& params)
+: params_(configure(params)),
+  population_(params.POPSIZE, params.NUM_FOUNDERS) {}
+
+Simulation::Simulation(const SimulationParams& params, std::istream& snapshot)
+: params_(configure(params)),
+  population_(snapshot) {}
+
+Simulation::~Simulation() = default;
+
+void Simulation::observe(observer_type observer, const size_t interval) {
+    if (interval == 0u) throw std::invalid_argument("interval must be positive");
+    observers_.emplace_back(interval, std::move(observer));
+}
+
+bool Simulation::step() {
+    constexpr double margin = 0.1;
+    ++generation_;
+    Population::hyperactivate(generation_, params_.HYPERACTIVATE);
+    const bool is_observed = std::any_of(observers_.begin(), observers_.end(),
+      [this](const auto& p) {return generation_ % p.first == 0u;});
+    std::vector<double> fitness;
+    const auto sketch = population_.step(max_fitness_, is_observed ? &fitness : nullptr);
+    max_fitness_ = std::min(sketch.max() + margin, 1.0);
+    if (Transposon::can_speciate() && generation_ % params_.SPECIES_INTERVAL == 0u) {
+        Stopwatch stopwatch;
+        population_.census(&stopwatch);
+    }
+    Observation observation(generation_, population_, fitness, sketch);
+    for (const auto& p: observers_) {
+        if (generation_ % p.first == 0u) p.second(observation);
+    }
+    return !population_.is_extinct();
+}
+
+bool Simulation::run(const size_t generations) {
+    for (size_t i=0u; i<generations; ++i) {
+        if (!step()) return false;
+    }
+    return true;
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
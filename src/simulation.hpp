@@ -0,0 +1,148 @@
+/*! @file simulation.hpp
+    @brief Interface of Simulation class for embedding tek2 as a library
+*/
+#pragma once
+#ifndef TEK_SIMULATION_HPP_
+#define TEK_SIMULATION_HPP_
+
+#include "population.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <memory>
+#include <functional>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+class Statistics;
+
+//! @brief Parameters for Simulation class
+/*! @ingroup params
+*/
+struct SimulationParams {
+    //! number of individuals
+    size_t POPSIZE = 500u;
+    //! initial number of individuals with TE
+    size_t NUM_FOUNDERS = 1u;
+    //! generation to introduce a hyperactivating mutation; 0 for never
+    size_t HYPERACTIVATE = 0u;
+    //! interval of species evaluation if TEs can speciate
+    size_t SPECIES_INTERVAL = 10u;
+    //! seed of random number generators
+    uint64_t SEED = 42u;
+    //! passed to Population::param()
+    PopulationParams POPULATION;
+    //! passed to Haploid::param()
+    HaploidParams HAPLOID;
+    //! passed to Transposon::param()
+    TransposonParams TRANSPOSON;
+};
+
+/*! @brief Read-only view of a population passed to observers
+
+    References are valid only during the callback.
+*/
+class Observation {
+  public:
+    //! constructor
+    Observation(size_t generation, const Population& population,
+                const std::vector<double>& fitness, const FitnessSketch& sketch) noexcept
+    : generation_(generation), population_(population), fitness_(fitness), sketch_(sketch) {}
+    //! destructor
+    ~Observation();
+
+    //! number of generations simulated
+    size_t generation() const noexcept {return generation_;}
+    //! vector of chromosomes; (2i, 2i + 1) is the i-th individual
+    const std::vector<Haploid>& gametes() const noexcept {return population_.gametes();}
+    //! fitness of the offspring accepted in this generation
+    const std::vector<double>& fitness() const noexcept {return fitness_;}
+    //! quantiles, mean, and variance of fitness()
+    const FitnessSketch& fitness_sketch() const noexcept {return sketch_;}
+    //! totals of TEs maintained without scanning the population
+    const Census& counts() const noexcept {return population_.counts();}
+    //! TE counts per species; collected on first call and shared among observers
+    const Statistics& statistics() const;
+
+  private:
+    //! number of generations simulated
+    const size_t generation_;
+    //! observed population
+    const Population& population_;
+    //! fitness record of this generation
+    const std::vector<double>& fitness_;
+    //! fitness distribution of this generation
+    const FitnessSketch& sketch_;
+    //! cache of statistics()
+    mutable std::unique_ptr<Statistics> statistics_;
+};
+
+/*! @brief Simulation advanced generation by generation without writing files
+
+    @code
+    tek::SimulationParams params;
+    params.POPSIZE = 1000u;
+    tek::Simulation sim(params);
+    sim.observe([](const tek::Observation& x) {
+        std::cout << x.generation() << "\t" << x.statistics().num_transposons() << "\n";
+    }, 100u);
+    sim.run(10000u);
+    @endcode
+
+    Parameters are static members of the core classes,
+    so that only one instance should exist at a time.
+    Link to the CMake target `tek2::tek2` to use the default LENGTH.
+*/
+class Simulation {
+  public:
+    //! callback that receives a read-only view
+    using observer_type = std::function<void(const Observation&)>;
+
+    //! set parameters and found a population
+    explicit Simulation(const SimulationParams& params);
+    //! set parameters and start from a snapshot written by Population::save()
+    Simulation(const SimulationParams& params, std::istream& snapshot);
+    //! destructor
+    ~Simulation();
+    //! noncopyable
+    Simulation(const Simulation&) = delete;
+
+    //! call `observer` at every `interval` generations in order of registration
+    void observe(observer_type observer, size_t interval = 1u);
+    //! proceed one generation, call observers, and return false if TEs are extinct
+    bool step();
+    //! call step() up to `generations` times and return false if TEs are extinct
+    bool run(size_t generations);
+
+    //! number of generations simulated
+    size_t generation() const noexcept {return generation_;}
+    //! current population
+    const Population& population() const noexcept {return population_;}
+
+  private:
+    //! set static parameters before constructing #population_
+    static const SimulationParams& configure(const SimulationParams&);
+
+    //! parameters given to the constructor
+    const SimulationParams params_;
+    //! population
+    Population population_;
+    //! (interval, observer)
+    std::vector<std::pair<size_t, observer_type>> observers_;
+    //! number of generations simulated
+    size_t generation_ = 0u;
+    //! upper bound of fitness passed to Population::step()
+    double max_fitness_ = 1.0;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_SIMULATION_HPP_ */
@@ -0,0 +1,90 @@
+/*! @file sitefreq.cpp
+    @brief Implementation of SiteFrequency class
+*/
+#include "sitefreq.hpp"
+
+#include <ostream>
+#include <map>
+#include <algorithm>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+SiteFrequency::SiteFrequency(const std::vector<Haploid>& gametes, const size_t begin, const size_t end)
+: num_gametes_(end - begin) {
+    std::vector<position_t> positions;
+    for (size_t i=begin; i<end; ++i) {
+        for (const auto& p: gametes[i]) {
+            positions.push_back(p.first);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    for (const auto x: positions) {
+        if (counts_.empty() || counts_.back().first != x) {
+            counts_.emplace_back(x, 1u);
+        } else {
+            ++counts_.back().second;
+        }
+    }
+}
+
+SiteFrequency& SiteFrequency::operator+=(const SiteFrequency& other) {
+    std::vector<std::pair<position_t, uint_fast32_t>> merged;
+    merged.reserve(counts_.size() + other.counts_.size());
+    auto it = counts_.cbegin();
+    auto other_it = other.counts_.cbegin();
+    while (it != counts_.cend() && other_it != other.counts_.cend()) {
+        if (it->first < other_it->first) {
+            merged.push_back(*it++);
+        } else if (other_it->first < it->first) {
+            merged.push_back(*other_it++);
+        } else {
+            merged.emplace_back(it->first, it->second + other_it->second);
+            ++it;
+            ++other_it;
+        }
+    }
+    merged.insert(merged.end(), it, counts_.cend());
+    merged.insert(merged.end(), other_it, other.counts_.cend());
+    counts_.swap(merged);
+    num_gametes_ += other.num_gametes_;
+    return *this;
+}
+
+const char* SiteFrequency::spectrum_header() noexcept {
+    return "generation\tgametes\tsites\n";
+}
+
+std::ostream& SiteFrequency::write_spectrum(std::ostream& ost, const size_t time) const {
+    std::map<uint_fast32_t, uint_fast64_t> spectrum;
+    for (const auto& p: counts_) {
+        ++spectrum[p.second];
+    }
+    for (const auto& p: spectrum) {
+        ost << time << "\t" << p.first << "\t" << p.second << "\n";
+    }
+    return ost;
+}
+
+const char* SiteFrequency::top_header() noexcept {
+    return "generation\trank\tposition\tgametes\tfrequency\n";
+}
+
+std::ostream& SiteFrequency::write_top(std::ostream& ost, const size_t time, size_t k) const {
+    k = std::min(k, counts_.size());
+    std::vector<std::pair<position_t, uint_fast32_t>> top(k);
+    std::partial_sort_copy(counts_.begin(), counts_.end(), top.begin(), top.end(),
+        [](const auto& x, const auto& y) {
+            return x.second > y.second || (x.second == y.second && x.first < y.first);
+        });
+    const double over_n = 1.0 / num_gametes_;
+    for (size_t i=0u; i<k; ++i) {
+        ost << time << "\t" << i + 1u << "\t" << top[i].first << "\t"
+            << top[i].second << "\t" << top[i].second * over_n << "\n";
+    }
+    return ost;
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
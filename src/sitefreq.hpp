@@ -0,0 +1,63 @@
+/*! @file sitefreq.hpp
+    @brief Interface of SiteFrequency class
+*/
+#pragma once
+#ifndef TEK_SITEFREQ_HPP_
+#define TEK_SITEFREQ_HPP_
+
+#include "haploid.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <utility>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+/*! @brief Number of gametes carrying a TE at each insertion site
+
+    Each thread counts a block of gametes into a sorted run,
+    and the runs are merged with operator+=().
+    Only occupied sites are stored, not the gametes.
+*/
+class SiteFrequency {
+  public:
+    //! Alias
+    using position_t = Haploid::position_t;
+
+    //! empty
+    SiteFrequency() = default;
+    //! count sites in gametes[begin, end)
+    SiteFrequency(const std::vector<Haploid>& gametes, size_t begin, size_t end);
+    //! merge sorted runs
+    SiteFrequency& operator+=(const SiteFrequency& other);
+
+    //! number of occupied sites
+    size_t num_sites() const noexcept {return counts_.size();}
+    //! number of gametes counted
+    size_t num_gametes() const noexcept {return num_gametes_;}
+
+    //! write number of sites per number of carrying gametes
+    std::ostream& write_spectrum(std::ostream&, size_t time) const;
+    //! write the `k` most frequent sites
+    std::ostream& write_top(std::ostream&, size_t time, size_t k) const;
+    //! header for write_spectrum()
+    static const char* spectrum_header() noexcept;
+    //! header for write_top()
+    static const char* top_header() noexcept;
+
+  private:
+    //! (position, number of gametes) sorted by position
+    std::vector<std::pair<position_t, uint_fast32_t>> counts_;
+    //! number of gametes counted
+    size_t num_gametes_ = 0u;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_SITEFREQ_HPP_ */
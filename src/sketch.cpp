@@ -0,0 +1,92 @@
+/*! @file sketch.cpp
+    @brief Implementation of FitnessSketch class
+*/
+#include "sketch.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+namespace tek {
+
+constexpr double FitnessSketch::ACCURACY;
+
+FitnessSketch::FitnessSketch(const double relative_accuracy)
+: gamma_((1.0 + relative_accuracy) / (1.0 - relative_accuracy)),
+  over_log_gamma_(1.0 / std::log(gamma_)) {
+    if (!(0.0 < relative_accuracy && relative_accuracy < 1.0)) {
+        throw std::invalid_argument("relative_accuracy must be in (0, 1)");
+    }
+}
+
+void FitnessSketch::extend(int lower, int upper) {
+    if (counts_.empty()) {
+        offset_ = lower;
+        counts_.resize(upper - lower + 1);
+        return;
+    }
+    lower = std::min(lower, offset_);
+    upper = std::max(upper, offset_ + static_cast<int>(counts_.size()) - 1);
+    if (lower < offset_) {
+        counts_.insert(counts_.begin(), offset_ - lower, 0u);
+        offset_ = lower;
+    }
+    counts_.resize(upper - lower + 1);
+}
+
+FitnessSketch& FitnessSketch::operator+=(const FitnessSketch& other) {
+    if (gamma_ != other.gamma_) {
+        throw std::invalid_argument("cannot merge sketches of different accuracy");
+    }
+    if (other.count_ == 0u) return *this;
+    if (!other.counts_.empty()) {
+        extend(other.offset_, other.offset_ + static_cast<int>(other.counts_.size()) - 1);
+        const int shift = other.offset_ - offset_;
+        for (size_t i=0u; i<other.counts_.size(); ++i) {
+            counts_[shift + i] += other.counts_[i];
+        }
+    }
+    zero_count_ += other.zero_count_;
+    const uint_fast64_t n = count_ + other.count_;
+    const double delta = other.mean_ - mean_;
+    m2_ += other.m2_ + delta * delta * count_ * other.count_ / n;
+    mean_ += delta * other.count_ / n;
+    count_ = n;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    return *this;
+}
+
+double FitnessSketch::quantile(const double q) const {
+    if (count_ == 0u) return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0.0) return min_;
+    if (q >= 1.0) return max_;
+    // rank of the deficit in ascending order
+    const double rank = (1.0 - q) * (count_ - 1u);
+    uint_fast64_t cumulative = zero_count_;
+    if (rank < cumulative) return max_;
+    for (size_t i=0u; i<counts_.size(); ++i) {
+        cumulative += counts_[i];
+        if (rank < cumulative) {
+            const int index = offset_ + static_cast<int>(i);
+            const double deficit = 2.0 * std::pow(gamma_, index) / (gamma_ + 1.0);
+            return std::min(std::max(1.0 - deficit, min_), max_);
+        }
+    }
+    return min_;
+}
+
+const char* FitnessSketch::header() noexcept {
+    return "generation\tcount\tmean\tvariance\tmin\tq05\tq25\tq50\tq75\tq95\tmax\n";
+}
+
+std::ostream& FitnessSketch::write(std::ostream& ost, const size_t time) const {
+    ost << time << "\t" << count_ << "\t" << mean_ << "\t" << variance()
+        << "\t" << min_;
+    for (const double q: {0.05, 0.25, 0.5, 0.75, 0.95}) {
+        ost << "\t" << quantile(q);
+    }
+    return ost << "\t" << max_ << "\n";
+}
+
+} // namespace tek
@@ -0,0 +1,110 @@
+/*! @file sketch.hpp
+    @brief Interface of FitnessSketch class
+*/
+#pragma once
+#ifndef TEK_SKETCH_HPP_
+#define TEK_SKETCH_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <vector>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+/*! @brief Mergeable quantile sketch with mean and variance of fitness
+
+    Since fitness \f$w \le 1\f$ is mostly close to 1,
+    the deficit \f$1 - w\f$ is counted in logarithmic buckets
+    \f$(\gamma^{i-1}, \gamma^i]\f$ with \f$\gamma = (1 + a) / (1 - a)\f$,
+    so that quantile() is within error \f$a(1 - w)\f$.
+    Memory is proportional to the log-range of deficits, not the number of values.
+    Each thread fills its own instance with add(),
+    and the instances are merged with operator+=() at the end of a generation.
+*/
+class FitnessSketch {
+  public:
+    //! default relative accuracy of quantile()
+    static constexpr double ACCURACY = 0.005;
+
+    //! empty sketch
+    explicit FitnessSketch(double relative_accuracy=ACCURACY);
+
+    //! add a value <= 1
+    void add(const double x) {
+        ++count_;
+        const double delta = x - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (x - mean_);
+        if (x < min_) min_ = x;
+        if (x > max_) max_ = x;
+        const double deficit = 1.0 - x;
+        if (deficit <= 0.0) {
+            ++zero_count_;
+            return;
+        }
+        increment(static_cast<int>(std::ceil(std::log(deficit) * over_log_gamma_)));
+    }
+    //! merge another sketch of the same accuracy
+    FitnessSketch& operator+=(const FitnessSketch& other);
+
+    //! number of values
+    uint_fast64_t count() const noexcept {return count_;}
+    //! mean of values
+    double mean() const noexcept {return mean_;}
+    //! unbiased variance; 0 if count() < 2
+    double variance() const noexcept {return (count_ > 1u) ? m2_ / (count_ - 1u) : 0.0;}
+    //! minimum value
+    double min() const noexcept {return min_;}
+    //! maximum value
+    double max() const noexcept {return max_;}
+    //! approximate q-quantile within accuracy relative to its deficit; NaN if empty
+    double quantile(double q) const;
+
+    //! write a row of count, moments, and quantiles
+    std::ostream& write(std::ostream&, size_t time) const;
+    //! header for write()
+    static const char* header() noexcept;
+
+  private:
+    //! count a value in bucket `index`, extending #counts_ if needed
+    void increment(int index) {
+        const int i = index - offset_;
+        if (0 <= i && i < static_cast<int>(counts_.size())) {
+            ++counts_[i];
+        } else {
+            extend(index, index);
+            ++counts_[index - offset_];
+        }
+    }
+    //! make #counts_ cover buckets [lower, upper]
+    void extend(int lower, int upper);
+
+    //! \f$\gamma\f$
+    double gamma_;
+    //! \f$1 / \log\gamma\f$
+    double over_log_gamma_;
+    //! bucket index of counts_[0]
+    int offset_ = 0;
+    //! counts of consecutive buckets from #offset_
+    std::vector<uint_fast64_t> counts_;
+    //! count of values >= 1
+    uint_fast64_t zero_count_ = 0u;
+    //! number of values
+    uint_fast64_t count_ = 0u;
+    //! running mean
+    double mean_ = 0.0;
+    //! sum of squared deviations from the mean
+    double m2_ = 0.0;
+    //! minimum value
+    double min_ = std::numeric_limits<double>::infinity();
+    //! maximum value
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+} // namespace tek
+
+#endif /* TEK_SKETCH_HPP_ */
@@ -0,0 +1,166 @@
+/*! @file statistics.cpp
+    @brief Implementation of Statistics class
+*/
+#include "statistics.hpp"
+#include "haploid.hpp"
+#include "column.hpp"
+
+#include <ostream>
+#include <numeric>
+#include <algorithm>
+
+namespace tek {
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+uint_fast64_t Statistics::Species::copy_number() const noexcept {
+    return std::accumulate(activity_classes.begin(), activity_classes.end(), uint_fast64_t{0u});
+}
+
+size_t Statistics::num_species() const noexcept {
+    return static_cast<size_t>(std::count_if(species_.begin(), species_.end(),
+        [](const Species& x) {return x.copy_number() > 0u;}));
+}
+
+Statistics::Species& Statistics::at(const uint_fast32_t species) {
+    if (species >= species_.size()) {
+        species_.resize(species + 1u);
+    }
+    auto& x = species_[species];
+    if (x.activity_classes.empty()) {
+        x.activity_classes.resize(Transposon::NUM_ACTIVITY_CLASSES);
+    }
+    return x;
+}
+
+void Statistics::collect(const Haploid& lchr, const Haploid& rchr) {
+    uint_fast64_t copy_number = 0u;
+    for (const auto* chr: {&lchr, &rchr}) {
+        for (const auto& p: *chr) {
+            const auto& te = *p.second;
+            auto& species = at(te.species());
+            const auto c = te.activity_class();
+            ++species.activity_classes[c];
+            species.num_active += (Transposon::activity_of_class(c) > 0.0);
+            species.nonsynonymous += te.nonsynonymous_sites().count();
+            species.synonymous += te.synonymous_sites().count();
+            if (with_families_) {
+                families_[te.species()].collect(te);
+            }
+            ++copy_number;
+        }
+    }
+    if (copy_number >= copy_number_.size()) {
+        copy_number_.resize(copy_number + 1u);
+    }
+    ++copy_number_[copy_number];
+    num_transposons_ += copy_number;
+}
+
+Statistics& Statistics::operator+=(const Statistics& other) {
+    for (uint_fast32_t i=0u; i<other.species_.size(); ++i) {
+        const auto& src = other.species_[i];
+        if (src.activity_classes.empty()) continue;
+        auto& dst = at(i);
+        for (uint_fast32_t c=0u; c<Transposon::NUM_ACTIVITY_CLASSES; ++c) {
+            dst.activity_classes[c] += src.activity_classes[c];
+        }
+        dst.num_active += src.num_active;
+        dst.nonsynonymous += src.nonsynonymous;
+        dst.synonymous += src.synonymous;
+    }
+    if (other.copy_number_.size() > copy_number_.size()) {
+        copy_number_.resize(other.copy_number_.size());
+    }
+    for (size_t i=0u; i<other.copy_number_.size(); ++i) {
+        copy_number_[i] += other.copy_number_[i];
+    }
+    for (const auto& p: other.families_) {
+        families_[p.first] += p.second;
+    }
+    num_transposons_ += other.num_transposons_;
+    return *this;
+}
+
+std::map<uint_fast32_t, std::map<double, uint_fast64_t>> Statistics::activity() const {
+    std::map<uint_fast32_t, std::map<double, uint_fast64_t>> counter;
+    for (uint_fast32_t i=0u; i<species_.size(); ++i) {
+        const auto& classes = species_[i].activity_classes;
+        for (uint_fast32_t c=0u; c<classes.size(); ++c) {
+            if (classes[c] > 0u) {
+                counter[i][Transposon::activity_of_class(c)] += classes[c];
+            }
+        }
+    }
+    return counter;
+}
+
+const char* Statistics::activity_header() noexcept {
+    return "generation\tspecies\tactivity\tcopy_number\n";
+}
+
+std::ostream& Statistics::write_activity(std::ostream& ost, const size_t time) const {
+    for (const auto& sp: activity()) {
+        for (const auto& act_cnt: sp.second) {
+            ost << time << "\t" << sp.first << "\t"
+                << act_cnt.first << "\t" << act_cnt.second << "\n";
+        }
+    }
+    return ost;
+}
+
+std::vector<ColumnSpec> Statistics::activity_columns() {
+    return {
+      ColumnSpec::of<uint32_t>("species"),
+      ColumnSpec::of<double>("activity"),
+      ColumnSpec::of<uint32_t>("copy_number")
+    };
+}
+
+void Statistics::write_activity(ColumnWriter& table, const size_t time) const {
+    std::vector<uint32_t> species;
+    std::vector<double> activity;
+    std::vector<uint32_t> copy_number;
+    for (const auto& sp: this->activity()) {
+        for (const auto& act_cnt: sp.second) {
+            species.push_back(static_cast<uint32_t>(sp.first));
+            activity.push_back(act_cnt.first);
+            copy_number.push_back(static_cast<uint32_t>(act_cnt.second));
+        }
+    }
+    table.append(0u, species);
+    table.append(1u, activity);
+    table.append(2u, copy_number);
+    table.write_chunk(time);
+}
+
+const char* Statistics::species_header() noexcept {
+    return "generation\tspecies\tcopy_number\tactive\tdn\tds\n";
+}
+
+std::ostream& Statistics::write_species(std::ostream& ost, const size_t time) const {
+    for (uint_fast32_t i=0u; i<species_.size(); ++i) {
+        const auto& x = species_[i];
+        const auto copy_number = x.copy_number();
+        if (copy_number == 0u) continue;
+        ost << time << "\t" << i << "\t" << copy_number << "\t" << x.num_active << "\t"
+            << (x.nonsynonymous * Transposon::OVER_NONSYNONYMOUS_SITES / copy_number) << "\t"
+            << (x.synonymous * Transposon::OVER_SYNONYMOUS_SITES / copy_number) << "\n";
+    }
+    return ost;
+}
+
+const char* Statistics::copy_number_header() noexcept {
+    return "generation\tcopy_number\tindividuals\n";
+}
+
+std::ostream& Statistics::write_copy_number(std::ostream& ost, const size_t time) const {
+    for (size_t i=0u; i<copy_number_.size(); ++i) {
+        if (copy_number_[i] == 0u) continue;
+        ost << time << "\t" << i << "\t" << copy_number_[i] << "\n";
+    }
+    return ost;
+}
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
@@ -0,0 +1,102 @@
+/*! @file statistics.hpp
+    @brief Interface of Statistics class
+*/
+#pragma once
+#ifndef TEK_STATISTICS_HPP_
+#define TEK_STATISTICS_HPP_
+
+#include "transposon.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <map>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+class ColumnWriter;
+struct ColumnSpec;
+
+inline namespace TEK_LENGTH_NAMESPACE {
+
+class Haploid;
+
+/*! @brief Population statistics accumulated in a single pass
+
+    Each thread collects individuals into its own object,
+    and the partial results are merged with operator+=().
+*/
+class Statistics {
+  public:
+    //! constructor; TransposonFamily is collected if `with_families`
+    explicit Statistics(bool with_families = false) noexcept
+    : with_families_(with_families) {}
+
+    //! accumulate TEs of an individual
+    void collect(const Haploid& lchr, const Haploid& rchr);
+    //! merge partial results
+    Statistics& operator+=(const Statistics& other);
+
+    //! total number of TEs
+    uint_fast64_t num_transposons() const noexcept {return num_transposons_;}
+    //! number of species with one or more copies
+    size_t num_species() const noexcept;
+    //! species => family; empty unless constructed `with_families`
+    const std::map<uint_fast32_t, TransposonFamily>& families() const noexcept {return families_;}
+
+    //! write activity counts
+    std::ostream& write_activity(std::ostream&, size_t time) const;
+    //! write activity counts as a chunk of columnar records
+    void write_activity(ColumnWriter&, size_t time) const;
+    //! write copy number, active copy number, mean dn, and mean ds of each species
+    std::ostream& write_species(std::ostream&, size_t time) const;
+    //! write distribution of copy number per individual
+    std::ostream& write_copy_number(std::ostream&, size_t time) const;
+
+    //! columns for write_activity(ColumnWriter&, size_t)
+    static std::vector<ColumnSpec> activity_columns();
+    //! header for write_activity(std::ostream&, size_t)
+    static const char* activity_header() noexcept;
+    //! header for write_species()
+    static const char* species_header() noexcept;
+    //! header for write_copy_number()
+    static const char* copy_number_header() noexcept;
+
+  private:
+    //! per-species accumulator
+    struct Species {
+        //! Transposon::activity_class() => copy number
+        std::vector<uint_fast64_t> activity_classes;
+        //! number of TEs with nonzero activity
+        uint_fast64_t num_active = 0u;
+        //! sum of nonsynonymous mutations
+        uint_fast64_t nonsynonymous = 0u;
+        //! sum of synonymous mutations
+        uint_fast64_t synonymous = 0u;
+        //! number of TEs
+        uint_fast64_t copy_number() const noexcept;
+    };
+
+    //! species => activity => copy number, merging classes with the same activity
+    std::map<uint_fast32_t, std::map<double, uint_fast64_t>> activity() const;
+    //! return accumulator of the species
+    Species& at(uint_fast32_t species);
+
+    //! indexed by species
+    std::vector<Species> species_;
+    //! copy number per individual => number of individuals
+    std::vector<uint_fast64_t> copy_number_;
+    //! species => family
+    std::map<uint_fast32_t, TransposonFamily> families_;
+    //! total number of TEs
+    uint_fast64_t num_transposons_ = 0u;
+    //! collect #families_ or not
+    bool with_families_ = false;
+};
+
+} // namespace TEK_LENGTH_NAMESPACE
+} // namespace tek
+
+#endif /* TEK_STATISTICS_HPP_ */
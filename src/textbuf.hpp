@@ -0,0 +1,116 @@
+/*! @file textbuf.hpp
+    @brief Interface of TextBuffer class
+*/
+#pragma once
+#ifndef TEK_TEXTBUF_HPP_
+#define TEK_TEXTBUF_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <string>
+#include <ostream>
+#include <type_traits>
+
+/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////
+
+namespace tek {
+
+/*! @brief Fixed-size text buffer in front of std::ostream
+
+    Integers are formatted without locale and stream state.
+    The buffer is flushed when full and on destruction.
+*/
+class TextBuffer {
+  public:
+    //! constructor
+    explicit TextBuffer(std::ostream& ost) noexcept: ost_(ost) {}
+    //! flush on destruction
+    ~TextBuffer() {flush();}
+    //! noncopyable
+    TextBuffer(const TextBuffer&) = delete;
+
+    //! write a character
+    TextBuffer& operator<<(char c) {
+        if (pos_ == buffer_.size()) flush();
+        buffer_[pos_++] = c;
+        return *this;
+    }
+    //! write a string
+    TextBuffer& operator<<(const std::string& s) {
+        return write(s.data(), s.size());
+    }
+    //! write a C string
+    TextBuffer& operator<<(const char* s) {
+        return write(s, std::strlen(s));
+    }
+    //! write bool as 0 or 1
+    TextBuffer& operator<<(bool x) {
+        return *this << (x ? '1' : '0');
+    }
+    //! write an integer
+    template <class T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>* = nullptr>
+    TextBuffer& operator<<(T x) {
+        char digits[24];
+        char* const end = digits + sizeof(digits);
+        char* begin = nullptr;
+        if (std::is_signed<T>::value && x < 0) {
+            begin = format_uint(0u - static_cast<uint_fast64_t>(x), end);
+            *--begin = '-';
+        } else {
+            begin = format_uint(static_cast<uint_fast64_t>(x), end);
+        }
+        return write(begin, static_cast<size_t>(end - begin));
+    }
+    //! write characters
+    TextBuffer& write(const char* s, size_t n) {
+        if (pos_ + n > buffer_.size()) {
+            flush();
+            if (n > buffer_.size()) {
+                ost_.write(s, static_cast<std::streamsize>(n));
+                return *this;
+            }
+        }
+        std::memcpy(buffer_.data() + pos_, s, n);
+        pos_ += n;
+        return *this;
+    }
+    //! write buffered characters to the stream
+    void flush() {
+        ost_.write(buffer_.data(), static_cast<std::streamsize>(pos_));
+        pos_ = 0u;
+    }
+
+  private:
+    //! format x backward from end, two digits at a time, and return the beginning
+    static char* format_uint(uint_fast64_t x, char* end) noexcept {
+        static constexpr char PAIRS[] =
+          "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+          "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+          "8081828384858687888990919293949596979899";
+        while (x >= 100u) {
+            const auto i = 2u * (x % 100u);
+            x /= 100u;
+            *--end = PAIRS[i + 1u];
+            *--end = PAIRS[i];
+        }
+        if (x >= 10u) {
+            *--end = PAIRS[2u * x + 1u];
+            *--end = PAIRS[2u * x];
+        } else {
+            *--end = static_cast<char>('0' + x);
+        }
+        return end;
+    }
+
+    //! output stream
+    std::ostream& ost_;
+    //! characters not yet written to #ost_
+    std::array<char, 8192u> buffer_;
+    //! number of characters in #buffer_
+    size_t pos_ = 0u;
+};
+
+} // namespace tek
+
+#endif /* TEK_TEXTBUF_HPP_ */
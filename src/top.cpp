@@ -0,0 +1,129 @@
+/*! @file top.cpp
+    @brief Defines main() of tek2-top to watch processes run with `--metrics`
+*/
+#include "metrics.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <signal.h>
+
+namespace {
+
+const char* USAGE = R"(Usage: tek2-top [options]
+
+Show live metrics of tek2 processes running with --metrics.
+
+  -i SECONDS      repeat every SECONDS instead of once
+  --kill-te N     send SIGTERM to processes with more than N TEs
+  --clean         remove pages left by dead processes
+  -h, --help      print this help
+)";
+
+//! options
+struct Options {
+    //! seconds between updates; 0 to print once
+    double interval = 0.0;
+    //! threshold of TE count for SIGTERM; 0 to disable
+    unsigned long long kill_te = 0u;
+    //! remove pages of dead processes
+    bool clean = false;
+};
+
+//! label of RunState or "dead"
+const char* state_name(const tek::MetricsValues& x, bool alive) {
+    if (!alive) return "dead";
+    switch (x.state) {
+      case tek::RunState::running: return "running";
+      case tek::RunState::finished: return "finished";
+      case tek::RunState::extinct: return "extinct";
+    }
+    return "?";
+}
+
+//! print a table of all processes and their sums
+void print(const Options& options) {
+    using namespace std::chrono;
+    const double now = duration_cast<duration<double>>(system_clock::now().time_since_epoch()).count();
+    std::cout << std::left
+              << std::setw(8) << "pid" << std::setw(9) << "state"
+              << std::right
+              << std::setw(14) << "generation" << std::setw(9) << "gen/s"
+              << std::setw(11) << "TEs" << std::setw(8) << "species"
+              << std::setw(9) << "fitness" << std::setw(8) << "accept"
+              << std::setw(10) << "RSS(MiB)" << std::setw(9) << "idle(s)"
+              << "  directory\n";
+    size_t num_alive = 0u;
+    unsigned long long total_te = 0u;
+    double total_rss = 0.0, total_rate = 0.0;
+    for (const auto& name: tek::Metrics::list()) {
+        tek::MetricsValues x;
+        if (!tek::Metrics::read(name, &x)) continue;
+        const bool alive = (::kill(static_cast<pid_t>(x.pid), 0) == 0 || errno != ESRCH);
+        if (!alive && options.clean) {
+            tek::Metrics::remove(name);
+            continue;
+        }
+        const double rss = x.resident_bytes / 1048576.0;
+        const double idle = now - x.update_ns * 1e-9;
+        bool killed = false;
+        if (alive && options.kill_te > 0u && x.num_transposons > options.kill_te) {
+            killed = (::kill(static_cast<pid_t>(x.pid), SIGTERM) == 0);
+        }
+        std::cout << std::left
+                  << std::setw(8) << x.pid << std::setw(9) << (killed ? "killed" : state_name(x, alive))
+                  << std::right << std::fixed
+                  << std::setw(14) << (std::to_string(x.generation) + "/" + std::to_string(x.max_generations))
+                  << std::setw(9) << std::setprecision(1) << x.generations_per_sec
+                  << std::setw(11) << x.num_transposons << std::setw(8) << x.num_species
+                  << std::setw(9) << std::setprecision(4) << x.mean_fitness
+                  << std::setw(8) << std::setprecision(3) << x.acceptance_rate
+                  << std::setw(10) << std::setprecision(1) << rss
+                  << std::setw(9) << std::setprecision(0) << idle
+                  << "  " << x.directory << "\n";
+        if (alive && x.state == tek::RunState::running) {
+            ++num_alive;
+            total_te += x.num_transposons;
+            total_rss += rss;
+            total_rate += x.generations_per_sec;
+        }
+    }
+    std::cout << "# running: " << num_alive
+              << ", gen/s: " << std::fixed << std::setprecision(1) << total_rate
+              << ", TEs: " << total_te
+              << ", RSS(MiB): " << total_rss << std::endl;
+}
+
+}
+
+//! Print metrics of tek2 processes once or repeatedly
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << USAGE;
+            return 0;
+        } else if (arg == "-i" && i + 1 < argc) {
+            options.interval = std::atof(argv[++i]);
+        } else if (arg == "--kill-te" && i + 1 < argc) {
+            options.kill_te = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--clean") {
+            options.clean = true;
+        } else {
+            std::cerr << USAGE;
+            return 1;
+        }
+    }
+    while (true) {
+        print(options);
+        if (options.interval <= 0.0) break;
+        std::this_thread::sleep_for(std::chrono::duration<double>(options.interval));
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -2,19 +2,26 @@
     @brief Implementation of Transposon class
 */
 #include "transposon.hpp"
+#include "textbuf.hpp"
+#include "binary.hpp"
 
 #include <wtl/debug.hpp>
 #include <wtl/numeric.hpp>
 
 #include <cmath>
+#include <sstream>
 
 namespace tek {
 
+inline namespace TEK_LENGTH_NAMESPACE {
+
 Transposon::param_type Transposon::PARAM_;
 double Transposon::THRESHOLD_ = 0.0;
-std::array<double, Transposon::NUM_NONSYNONYMOUS_SITES> Transposon::ACTIVITY_;
+std::array<double, Transposon::NUM_NONSYNONYMOUS_SITES + 1u> Transposon::ACTIVITY_;
+std::array<std::string, Transposon::NUM_ACTIVITY_CLASSES> Transposon::ACTIVITY_TEXT_;
 std::atomic_uint_fast32_t Transposon::NUM_SPECIES_{1u};
 std::unordered_map<uint_fast64_t, double> Transposon::INTERACTION_COEFS_;
+std::atomic_uint_fast64_t Transposon::NEXT_ID_{1u};
 
 static_assert(std::is_nothrow_default_constructible<Transposon>{}, "");
 static_assert(std::is_nothrow_move_constructible<Transposon>{}, "");
@@ -28,9 +35,14 @@ void Transposon::param(const param_type& p) {HERE;
     NUM_SPECIES_.store(1u);
     if (has_been_executed) return;
     THRESHOLD_ = 1.0 - param().ALPHA;
-    for (uint_fast32_t i=0u; i<NUM_NONSYNONYMOUS_SITES; ++i) {
+    for (uint_fast32_t i=0u; i<=NUM_NONSYNONYMOUS_SITES; ++i) {
         ACTIVITY_[i] = calc_activity(i);
     }
+    for (uint_fast32_t c=0u; c<NUM_ACTIVITY_CLASSES; ++c) {
+        std::ostringstream oss;
+        oss << activity_of_class(c);
+        ACTIVITY_TEXT_[c] = oss.str();
+    }
     has_been_executed = true;
 }
 
@@ -48,28 +60,109 @@ std::ostream& Transposon::write_summary(std::ostream& ost) const {
                << activity();
 }
 
+TextBuffer& Transposon::write_summary(TextBuffer& buffer) const {
+    return buffer << species_ << ':'
+           << has_indel_ << ':'
+           << nonsynonymous_sites_.count() << ':'
+           << synonymous_sites_.count() << ':'
+           << ACTIVITY_TEXT_[activity_class()];
+}
+
 std::ostream& Transposon::write_fasta(std::ostream& ost) const {
     write_metadata(ost << ">");
     write_sequence(ost << "\n");
     return ost << "\n";
 }
 
-std::ostream& Transposon::write_metadata(std::ostream& ost) const {
-    return ost << "te=" << this
-        << " species=" << species_ << " indel=" << has_indel_
+std::ostream& Transposon::write_metadata(std::ostream& ost, const void* label) const {
+    return write_properties(ost << "te=" << (label ? label : this) << " ");
+}
+
+std::ostream& Transposon::write_properties(std::ostream& ost) const {
+    return ost << "species=" << species_ << " indel=" << has_indel_
         << " dn=" << dn() << " ds=" << ds()
         << " activity=" << activity();
 }
 
 std::ostream& Transposon::write_sequence(std::ostream& ost) const {
-    for (uint_fast32_t in=0u, is=0u; in<NUM_NONSYNONYMOUS_SITES; ++in, ++is) {
-        ost << nonsynonymous_sites_[in];
-        ost << nonsynonymous_sites_[++in];
-        ost <<    synonymous_sites_[is];
+    char buffer[LENGTH];
+    return ost.write(buffer, encode_sequence(buffer) - buffer);
+}
+
+char* Transposon::encode_sequence(char* buffer) const noexcept {
+    // 6-bit codon code => 3 characters
+    static const auto CODONS = [] {
+        constexpr char NUCLEOTIDE[] = "ATGC";
+        std::array<std::array<char, 3u>, 64u> table;
+        for (uint_fast8_t code=0u; code<64u; ++code) {
+            table[code] = {{NUCLEOTIDE[code >> 4u], NUCLEOTIDE[(code >> 2u) & 0b11u], NUCLEOTIDE[code & 0b11u]}};
+        }
+        return table;
+    }();
+    for (uint_fast32_t in=0u, is=0u; in<NUM_NONSYNONYMOUS_SITES; in+=2u, ++is) {
+        const auto code = (nonsynonymous_sites_.get(in) << 4u)
+                        | (nonsynonymous_sites_.get(in + 1u) << 2u)
+                        | synonymous_sites_.get(is);
+        const auto& codon = CODONS[code];
+        *buffer++ = codon[0];
+        *buffer++ = codon[1];
+        *buffer++ = codon[2];
+    }
+    return buffer;
+}
+
+std::ostream& Transposon::write_binary(std::ostream& ost) const {
+    // one byte per codon in the same code as encode_sequence()
+    std::array<uint8_t, NUM_SYNONYMOUS_SITES> codons;
+    for (uint_fast32_t in=0u, is=0u; in<NUM_NONSYNONYMOUS_SITES; in+=2u, ++is) {
+        codons[is] = static_cast<uint8_t>((nonsynonymous_sites_.get(in) << 4u)
+                                        | (nonsynonymous_sites_.get(in + 1u) << 2u)
+                                        | synonymous_sites_.get(is));
+    }
+    write_pod(ost, static_cast<uint32_t>(species_));
+    write_pod(ost, static_cast<uint8_t>(has_indel_ | (is_hyperactive_ << 1u)));
+    return write_pod(ost, codons);
+}
+
+Transposon Transposon::read_binary(std::istream& ist) {
+    const auto species = read_pod<uint32_t>(ist);
+    const auto flags = read_pod<uint8_t>(ist);
+    const auto codons = read_pod<std::array<uint8_t, NUM_SYNONYMOUS_SITES>>(ist);
+    std::valarray<uint_fast8_t> non(NUM_NONSYNONYMOUS_SITES);
+    std::valarray<uint_fast8_t> syn(NUM_SYNONYMOUS_SITES);
+    for (uint_fast32_t in=0u, is=0u; in<NUM_NONSYNONYMOUS_SITES; in+=2u, ++is) {
+        non[in] = (codons[is] >> 4u) & 0b11u;
+        non[in + 1u] = (codons[is] >> 2u) & 0b11u;
+        syn[is] = codons[is] & 0b11u;
+    }
+    Transposon x(DNA<NUM_NONSYNONYMOUS_SITES>(std::move(non)), DNA<NUM_SYNONYMOUS_SITES>(std::move(syn)));
+    x.species_ = species;
+    x.has_indel_ = static_cast<bool>(flags & 0b01u);
+    x.is_hyperactive_ = static_cast<bool>(flags & 0b10u);
+    x.id_ = NEXT_ID_++;
+    return x;
+}
+
+std::ostream& Transposon::write_species_binary(std::ostream& ost) {
+    write_pod(ost, static_cast<uint32_t>(NUM_SPECIES_.load()));
+    write_pod(ost, static_cast<uint64_t>(INTERACTION_COEFS_.size()));
+    for (const auto& p: INTERACTION_COEFS_) {
+        write_pod(ost, static_cast<uint64_t>(p.first));
+        write_pod(ost, p.second);
     }
     return ost;
 }
 
+void Transposon::read_species_binary(std::istream& ist) {
+    NUM_SPECIES_.store(read_pod<uint32_t>(ist));
+    INTERACTION_COEFS_.clear();
+    const auto n = read_pod<uint64_t>(ist);
+    for (uint64_t i=0u; i<n; ++i) {
+        const auto key = read_pod<uint64_t>(ist);
+        INTERACTION_COEFS_.emplace(key, read_pod<double>(ist));
+    }
+}
+
 //! shortcut for Transposon::write_summary()
 std::ostream& operator<<(std::ostream& ost, const Transposon& x) {
     return x.write_summary(ost);
@@ -84,4 +177,5 @@ void Transposon::write_activity(std::ostream& ost, const double alpha, const uns
     }
 }
 
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
@@ -5,9 +5,11 @@
 #ifndef TEK_TRANSPOSON_HPP_
 #define TEK_TRANSPOSON_HPP_
 
+#include "length.hpp"
 #include "dna.hpp"
 
 #include <iosfwd>
+#include <string>
 #include <array>
 #include <unordered_map>
 #include <random>
@@ -17,8 +19,9 @@
 
 namespace tek {
 
-//! \f$L\f$, sequence length of TE (bp)
-constexpr uint_fast32_t LENGTH = 300u;
+class TextBuffer;
+
+inline namespace TEK_LENGTH_NAMESPACE {
 
 //! @brief Parameters for Transposon class
 /*! @ingroup params
@@ -52,6 +55,9 @@ class Transposon {
     static constexpr double MAX_TRANSPOSITION_RATE = 0.01;
     //! @} params /2/////////3/////////4/////////5/////////6/////////7/////////
 
+    //! number of distinct values of activity_class()
+    static constexpr uint_fast32_t NUM_ACTIVITY_CLASSES = 2u * (NUM_NONSYNONYMOUS_SITES + 1u) + 1u;
+
     //! resiprocal of synonymous sites
     static constexpr double OVER_SYNONYMOUS_SITES = 1.0 / NUM_SYNONYMOUS_SITES;
     //! resiprocal of nonsynonymous sites
@@ -87,6 +93,13 @@ class Transposon {
         species_ = NUM_SPECIES_++;
     }
 
+    //! assign a new #id_ to this copy and return the previous one
+    uint_fast64_t branch() noexcept {
+        const auto parent = id_;
+        id_ = NEXT_ID_++;
+        return parent;
+    }
+
     //! set #has_indel_
     void indel() noexcept {has_indel_ = true;}
 
@@ -99,11 +112,40 @@ class Transposon {
         return (is_hyperactive_ ? 2.0 : 1.0) * ACTIVITY_[nonsynonymous_sites_.count()];
     }
 
+    //! dense index of activity: 0 for indel, otherwise by hyperactivity and nonsynonymous mutations
+    uint_fast32_t activity_class() const noexcept {
+        if (has_indel_) return 0u;
+        return 1u + (is_hyperactive_ ? NUM_NONSYNONYMOUS_SITES + 1u : 0u) + nonsynonymous_sites_.count();
+    }
+
+    //! activity() of TEs in the class
+    static double activity_of_class(uint_fast32_t c) noexcept {
+        if (c == 0u) return 0.0;
+        --c;
+        const bool is_hyperactive = (c > NUM_NONSYNONYMOUS_SITES);
+        if (is_hyperactive) c -= NUM_NONSYNONYMOUS_SITES + 1u;
+        return (is_hyperactive ? 2.0 : 1.0) * ACTIVITY_[c];
+    }
+
     //! \f$u_i = u_0 \times a_i\f$
     double transposition_rate() const noexcept {
         return MAX_TRANSPOSITION_RATE * activity();
     }
 
+    //! identical sequence and state
+    bool operator==(const Transposon& other) const noexcept {
+        return species_ == other.species_ &&
+               has_indel_ == other.has_indel_ &&
+               is_hyperactive_ == other.is_hyperactive_ &&
+               nonsynonymous_sites_ == other.nonsynonymous_sites_ &&
+               synonymous_sites_ == other.synonymous_sites_;
+    }
+    //! hash value consistent with operator==()
+    size_t hash() const noexcept {
+        const size_t x = nonsynonymous_sites_.hash();
+        const size_t y = synonymous_sites_.hash() + (species_ << 2u) + (has_indel_ << 1u) + is_hyperactive_;
+        return x ^ (y + 0x9e3779b97f4a7c15u + (x << 6u) + (x >> 2u));
+    }
     //! Hamming distance
     uint_fast32_t operator-(const Transposon& other) const noexcept {
         return (nonsynonymous_sites() - other.nonsynonymous_sites()) +
@@ -137,6 +179,12 @@ class Transposon {
     static bool can_speciate() noexcept {
         return param().LOWER_THRESHOLD < LENGTH;
     }
+    //! number of species that have appeared
+    static uint_fast32_t num_species() noexcept {return NUM_SPECIES_.load();}
+    //! true if TEs of different species may coexist; false for the single-species fitness path
+    static bool has_species() noexcept {
+        return can_speciate() || num_species() > 1u;
+    }
     //! clear #INTERACTION_COEFS_
     static void INTERACTION_COEFS_clear() noexcept {INTERACTION_COEFS_.clear();}
     //! setter of #INTERACTION_COEFS_
@@ -155,8 +203,12 @@ class Transposon {
     const DNA<NUM_SYNONYMOUS_SITES>& synonymous_sites() const noexcept {return synonymous_sites_;}
     //! getter of #has_indel_
     bool has_indel() const noexcept {return has_indel_;}
+    //! getter of #is_hyperactive_
+    bool is_hyperactive() const noexcept {return is_hyperactive_;}
     //! getter of #species_
     uint_fast32_t species() const noexcept {return species_;}
+    //! getter of #id_
+    uint_fast64_t id() const noexcept {return id_;}
     //! nonsynonymous substitution per nonsynonymous site
     double dn() const noexcept {return nonsynonymous_sites_.count() * OVER_NONSYNONYMOUS_SITES;}
     //! synonymous substitution per synonymous site
@@ -164,14 +216,28 @@ class Transposon {
 
     //! write summary
     std::ostream& write_summary(std::ostream&) const;
+    //! write summary in the same format as write_summary(std::ostream&)
+    TextBuffer& write_summary(TextBuffer&) const;
     //! write sequqnce with header in FASTA format
     std::ostream& write_fasta(std::ostream&) const;
-    //! write metadata for FASTA header
-    std::ostream& write_metadata(std::ostream&) const;
+    //! write metadata for FASTA header; label defaults to the address
+    std::ostream& write_metadata(std::ostream&, const void* label = nullptr) const;
+    //! write species, indel, dn, ds, and activity for FASTA header
+    std::ostream& write_properties(std::ostream&) const;
     //! write sequence
     std::ostream& write_sequence(std::ostream&) const;
+    //! write #LENGTH nucleotide characters to the buffer and return its end
+    char* encode_sequence(char* buffer) const noexcept;
     //! calculate and write activity for the given alpha and beta
     static void write_activity(std::ostream&, double alpha, unsigned int beta);
+    //! write binary for Population::save()
+    std::ostream& write_binary(std::ostream&) const;
+    //! read binary written by write_binary()
+    static Transposon read_binary(std::istream&);
+    //! write #NUM_SPECIES_ and #INTERACTION_COEFS_ in binary
+    static std::ostream& write_species_binary(std::ostream&);
+    //! read binary written by write_species_binary()
+    static void read_species_binary(std::istream&);
     friend std::ostream& operator<<(std::ostream&, const Transposon&);
 
     //! Set #PARAM_
@@ -198,11 +264,15 @@ class Transposon {
     //! 1 - TransposonParams::ALPHA
     static double THRESHOLD_;
     //! pre-calculated activity values
-    static std::array<double, NUM_NONSYNONYMOUS_SITES> ACTIVITY_;
+    static std::array<double, NUM_NONSYNONYMOUS_SITES + 1u> ACTIVITY_;
+    //! activity_of_class() formatted by std::ostream
+    static std::array<std::string, NUM_ACTIVITY_CLASSES> ACTIVITY_TEXT_;
     //! number of species; incremented by speciation
     static std::atomic_uint_fast32_t NUM_SPECIES_;
     //! interaction coefficients between species
     static std::unordered_map<uint_fast64_t, double> INTERACTION_COEFS_;
+    //! next value of #id_; 0 is the original TE
+    static std::atomic_uint_fast64_t NEXT_ID_;
 
     //! nonsynonymous sites
     DNA<NUM_NONSYNONYMOUS_SITES> nonsynonymous_sites_;
@@ -214,6 +284,8 @@ class Transposon {
     bool is_hyperactive_ = false;
     //! transposon species
     uint_fast32_t species_ = 0;
+    //! node in Genealogy; shared by copies until branch()
+    uint_fast64_t id_ = 0;
 };
 
 //! @cond
@@ -227,6 +299,13 @@ class TransposonFamily {
         ++size_;
     }
 
+    TransposonFamily& operator+=(const TransposonFamily& other) noexcept {
+        nonsynonymous_sites_ += other.nonsynonymous_sites_;
+        synonymous_sites_ += other.synonymous_sites_;
+        size_ += other.size_;
+        return *this;
+    }
+
     Transposon majority() const noexcept {
         return Transposon(nonsynonymous_sites_.majority(), synonymous_sites_.majority());
     }
@@ -240,6 +319,7 @@ class TransposonFamily {
 };
 //! @endcond
 
+} // namespace TEK_LENGTH_NAMESPACE
 } // namespace tek
 
 #endif /* TEK_TRANSPOSON_HPP_ */
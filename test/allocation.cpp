@@ -0,0 +1,104 @@
+#include "population.hpp"
+#include "haploid.hpp"
+#include "memory.hpp"
+
+#include <wtl/random.hpp>
+#include <sfmt.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<size_t> num_allocations{0u};
+}
+
+void* operator new(size_t size) {
+    num_allocations.fetch_add(1u, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1u)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
+
+namespace {
+
+//! number of operator new calls in a generation of Population::step()
+size_t step_allocations(size_t popsize) {
+    tek::Population pop(popsize, popsize);
+    for (int i = 0; i < 10; ++i) pop.step();
+    const size_t before = num_allocations.load();
+    pop.step();
+    return num_allocations.load() - before;
+}
+
+//! blocks freed by a thread that only frees are reused after it exits
+bool reuse_after_thread_exit() {
+    // a size class used nowhere else
+    constexpr size_t size = 4000u;
+    std::vector<void*> blocks(16u);
+    std::thread([&blocks] {
+        for (auto& p: blocks) p = tek::BlockPool::allocate(size);
+    }).join();
+    std::thread([&blocks] {
+        for (auto* p: blocks) tek::BlockPool::deallocate(p, size);
+    }).join();
+    std::vector<void*> reused(blocks.size());
+    size_t new_chunks = 0u;
+    std::thread([&reused, &new_chunks] {
+        const size_t before = num_allocations.load();
+        for (auto& p: reused) p = tek::BlockPool::allocate(size);
+        new_chunks = num_allocations.load() - before;
+    }).join();
+    std::sort(blocks.begin(), blocks.end());
+    std::sort(reused.begin(), reused.end());
+    return new_chunks == 0u && reused == blocks;
+}
+
+}
+
+int main() {
+    if (!reuse_after_thread_exit()) return 1;
+
+    tek::Population pop(100u, 100u);
+    for (int i = 0; i < 10; ++i) pop.step();
+    // headroom in the table of selection coefficients to avoid rehashing
+    tek::Haploid::insert_coefs_gp(1u << 16u);
+    const auto& coefs = tek::Haploid::SELECTION_COEFS_GP();
+    if (coefs.bucket_count() - coefs.size() < (1u << 14u)) {
+        tek::Haploid::insert_coefs_gp(coefs.bucket_count() + 1u);
+    }
+    const auto bucket_count = coefs.bucket_count();
+
+    tek::Haploid::URBG engine(42u);
+    std::uniform_int_distribution<size_t> dist_idx(0u, 99u);
+    std::vector<tek::Haploid> parents = pop.gametes();
+    std::vector<tek::Haploid> children(parents.size());
+    auto produce = [&](size_t i) {
+        const size_t mother = dist_idx(engine), father = dist_idx(engine);
+        auto egg = parents[2u * mother].gametogenesis(parents[2u * mother + 1u], engine);
+        auto sperm = parents[2u * father].gametogenesis(parents[2u * father + 1u], engine);
+        if (egg.fitness(sperm) < 0.0) return;
+        egg.transpose_mutate(sperm, engine);
+        children[i % children.size()] = std::move(egg);
+        children[(i + 1u) % children.size()] = std::move(sperm);
+    };
+    for (size_t i = 0u; i < 20000u; i += 2u) produce(i);
+    const size_t before = num_allocations.load();
+    for (size_t i = 0u; i < 20000u; i += 2u) produce(i);
+    const size_t per_offspring = num_allocations.load() - before;
+    std::cerr << "allocations in 10000 offspring: " << per_offspring << std::endl;
+    if (coefs.bucket_count() != bucket_count) return 1;
+    if (per_offspring != 0u) return 1;
+
+    // per generation, not per offspring
+    const size_t small = step_allocations(100u);
+    const size_t large = step_allocations(1000u);
+    std::cerr << "allocations in a generation: " << small << ", " << large << std::endl;
+    if (large > small + 2u) return 1;
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "bgzf.hpp"
+
+#include <wtl/concurrent.hpp>
+#include <wtl/zlib.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::string slurp(std::istream& ist) {
+    return std::string(std::istreambuf_iterator<char>(ist), std::istreambuf_iterator<char>());
+}
+
+std::string gunzip(const std::string& filename) {
+    wtl::zlib::ifstream ist(filename);
+    return slurp(ist);
+}
+
+}
+
+int main() {
+    const std::string filename = "tek-bgzf.tsv.gz";
+    std::ostringstream expected;
+    {
+        wtl::ThreadPool pool(2u);
+        tek::BgzfStream ost(filename, &pool);
+        ost << "generation\tvalue\n";
+        expected << "generation\tvalue\n";
+        for (unsigned t = 1u; t <= 6u; ++t) {
+            ost.mark(t);
+            for (unsigned i = 0u; i < 4000u * t; ++i) {
+                ost << t << "\t" << i * 7919u % 10007u << "\n";
+                expected << t << "\t" << i * 7919u % 10007u << "\n";
+            }
+            ost.mark(t);
+        }
+        ost.close();
+    }
+    const std::string content = gunzip(filename);
+    if (content != expected.str()) return 1;
+
+    std::ifstream ifs(filename, std::ios::binary);
+    const std::string compressed = slurp(ifs);
+    const std::string eof("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0\x1b\0\x03\0\0\0\0\0\0\0\0\0", 28u);
+    if (compressed.size() < eof.size()) return 1;
+    if (compressed.compare(compressed.size() - eof.size(), eof.size(), eof) != 0) return 1;
+
+    std::ifstream index(filename + ".idx");
+    std::string header;
+    std::getline(index, header);
+    std::cout << header << "\n";
+    unsigned key, num_entries = 0u;
+    size_t offset, within;
+    while (index >> key >> offset >> within) {
+        std::cout << key << "\t" << offset << "\t" << within << "\n";
+        ++num_entries;
+        std::ofstream tail("tek-bgzf-tail.gz", std::ios::binary);
+        tail << compressed.substr(offset);
+        tail.close();
+        const std::string rest = gunzip("tek-bgzf-tail.gz").substr(within);
+        const std::string first_row = std::to_string(key) + "\t0\n";
+        if (rest.compare(0u, first_row.size(), first_row) != 0) return 1;
+    }
+    if (num_entries != 6u) return 1;
+
+    tek::BgzfStream inline_ost("tek-bgzf-inline.gz");
+    inline_ost << expected.str();
+    inline_ost.close();
+    if (gunzip("tek-bgzf-inline.gz") != expected.str()) return 1;
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "column.hpp"
+
+#include <iostream>
+#include <numeric>
+
+int main() {
+    {
+        tek::ColumnWriter writer("tek-column.tekc", {
+          tek::ColumnSpec::of<uint32_t>("id"),
+          tek::ColumnSpec::of<double>("value")
+        });
+        for (uint64_t generation: {10u, 20u, 30u}) {
+            std::vector<uint32_t> id(generation);
+            std::iota(id.begin(), id.end(), 0u);
+            std::vector<double> value(id.begin(), id.end());
+            writer.append(0u, id);
+            writer.append(1u, value);
+            writer.write_chunk(generation);
+        }
+    }
+    tek::ColumnReader reader("tek-column.tekc");
+    for (const auto& spec: reader.columns()) {
+        std::cout << spec.name << " " << spec.type << +spec.width << "\n";
+    }
+    for (const auto generation: reader.generations()) {
+        const auto value = reader.read<double>("value", generation);
+        const double sum = std::accumulate(value.begin(), value.end(), 0.0);
+        std::cout << generation << " " << value.size() << " " << sum << "\n";
+        if (value.size() != generation) return 1;
+    }
+    try {
+        reader.read<int32_t>("id", 10u);
+        return 1;
+    } catch (const std::invalid_argument& e) {
+        std::cout << e.what() << std::endl;
+    }
+    return 0;
+}
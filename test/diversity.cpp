@@ -0,0 +1,37 @@
+#include "diversity.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
+
+#include <wtl/random.hpp>
+#include <sfmt.hpp>
+
+#include <iostream>
+#include <sstream>
+
+int main() {
+    tek::Haploid::initialize(100u, 0.01, 20000);
+    tek::Haploid::URBG engine(42u);
+    auto x = std::make_shared<tek::Transposon>();
+    auto y = std::make_shared<tek::Transposon>(*x);
+    for (int i = 0; i < 5; ++i) y->mutate(engine);
+    const auto distance = (*x - *y);
+    std::vector<tek::Haploid> gametes;
+    gametes.emplace_back(2u, std::vector<std::shared_ptr<tek::Transposon>>{x});
+    gametes.emplace_back(1u, std::vector<std::shared_ptr<tek::Transposon>>{y});
+    tek::Diversity diversity(gametes, 100u, 1u);
+    if (diversity.num_alleles() != 2u) return 1;
+    diversity += diversity.compare(0u, 2u);
+    diversity += diversity.compare(1u, 2u);
+    std::ostringstream oss;
+    diversity.write_distances(oss, 1u);
+    diversity.write_diversity(std::cout, 1u);
+    std::cout << oss.str();
+    // one identical pair of x, and two pairs of x and y
+    std::ostringstream expected;
+    expected << "1\t0\t0\t1\n";
+    if (distance > 0u) expected << "1\t0\t" << distance << "\t2\n";
+    if (oss.str() != expected.str()) return 1;
+    tek::Diversity sampled(gametes, 1u, 1u);
+    if (sampled.num_alleles() != 1u) return 1;
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "genealogy.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
+
+#include <iostream>
+
+int main() {
+    using tek::Genealogy;
+    tek::Haploid::initialize(100u, 0.01, 20000);
+    Genealogy::enabled(true);
+    auto root = std::make_shared<tek::Transposon>();
+    auto dead = std::make_shared<tek::Transposon>(*root);
+    Genealogy::branch(*dead, Genealogy::Origin::transposition);
+    auto unary = std::make_shared<tek::Transposon>(*root);
+    Genealogy::branch(*unary, Genealogy::Origin::mutation);
+    auto left = std::make_shared<tek::Transposon>(*unary);
+    Genealogy::branch(*left, Genealogy::Origin::mutation);
+    auto right = std::make_shared<tek::Transposon>(*left);
+    Genealogy::branch(*right, Genealogy::Origin::transposition);
+    std::vector<tek::Haploid> gametes;
+    gametes.emplace_back(3u, std::vector<std::shared_ptr<tek::Transposon>>{left, right});
+    gametes.emplace_back(1u, std::vector<std::shared_ptr<tek::Transposon>>{root});
+    if (Genealogy::size() != 4u) return 1;
+    Genealogy::simplify(gametes);
+    Genealogy::write(std::cout, gametes);
+    // dead is removed, and unary is merged into left
+    if (Genealogy::size() != 2u) return 1;
+    return 0;
+}
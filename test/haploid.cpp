@@ -81,6 +81,21 @@ inline void recombination() {
     std::cout << "\n";
 }
 
+//! the single-species path must give the same fitness as the general one
+inline bool single_species_fitness() {
+    tek::Haploid::URBG engine(42u);
+    const tek::Haploid zero;
+    for (const size_t n: {0u, 1u, 7u, 40u}) {
+        const tek::Haploid x(n), y(n / 2u);
+        tek::Haploid::insert_coefs_gp(x, engine);
+        tek::Haploid::insert_coefs_gp(y, engine);
+        for (const auto* other: {&zero, &y}) {
+            if (x.fitness<false>(*other) != x.fitness<true>(*other)) return false;
+        }
+    }
+    return true;
+}
+
 int main() {
     tek::Haploid::initialize(500u, 0.01, 20000);
     tek::Haploid x = tek::Haploid::copy_founder();
@@ -89,5 +104,6 @@ int main() {
     selection_coefs_gp();
     selection_coefs_cn();
     recombination();
+    if (!single_species_fitness()) return 1;
     return 0;
 }
@@ -0,0 +1,28 @@
+#include "inbox.hpp"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main() {
+    tek::Inbox<int> inbox;
+    std::vector<std::thread> workers;
+    for (int j = 0; j < 4; ++j) {
+        workers.emplace_back([&inbox, j] {
+            for (int i = 0; i < 1000; ++i) inbox.push(1000 * j + i);
+        });
+    }
+    for (auto& w: workers) w.join();
+    const auto items = inbox.drain();
+    std::cout << items.size() << std::endl;
+    if (items.size() != 4000u) return 1;
+    long sum = 0;
+    for (const int x: items) sum += x;
+    if (sum != 7998000) return 1;
+    if (!inbox.drain().empty()) return 1;
+    inbox.push(1);
+    inbox.push(2);
+    const auto ordered = inbox.drain();
+    if (ordered.size() != 2u || ordered[0] != 1 || ordered[1] != 2) return 1;
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include "memory.hpp"
+
+#include <iostream>
+#include <map>
+#include <thread>
+
+int main() {
+    using tek::Subsystem;
+    using tek::MemoryCounter;
+    using allocator = tek::CountingAllocator<std::pair<const int, double>, Subsystem::sites>;
+    auto x = std::make_unique<std::map<int, double, std::less<int>, allocator>>();
+    for (int i=0; i<100; ++i) x->emplace(i, 0.5);
+    std::cout << MemoryCounter::blocks(Subsystem::sites) << " blocks, "
+              << MemoryCounter::bytes(Subsystem::sites) << " bytes" << std::endl;
+    if (MemoryCounter::blocks(Subsystem::sites) != 100) return 1;
+    std::thread([&x] {x.reset();}).join();
+    if (MemoryCounter::blocks(Subsystem::sites) != 0) return 1;
+    if (MemoryCounter::bytes(Subsystem::sites) != 0) return 1;
+    auto te = tek::make_counted<Subsystem::transposons, int>(42);
+    if (MemoryCounter::blocks(Subsystem::transposons) != 1) return 1;
+    std::cout << "RSS: " << MemoryCounter::resident_bytes() << std::endl;
+    return 0;
+}
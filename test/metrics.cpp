@@ -0,0 +1,30 @@
+#include "metrics.hpp"
+
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+int main() {
+    const std::string name = "/tek2." + std::to_string(::getpid());
+    {
+        tek::Metrics metrics;
+        tek::MetricsValues values;
+        values.generation = 42u;
+        values.num_transposons = 1234u;
+        values.mean_fitness = 0.5;
+        tek::Metrics::publish(values);
+        bool listed = false;
+        for (const auto& x: tek::Metrics::list()) listed |= (x == name);
+        if (!listed) return 1;
+        tek::MetricsValues read;
+        if (!tek::Metrics::read(name, &read)) return 1;
+        std::cout << read.pid << " " << read.generation << " " << read.directory << std::endl;
+        if (read.pid != static_cast<uint64_t>(::getpid())) return 1;
+        if (read.generation != 42u || read.num_transposons != 1234u) return 1;
+        if (read.mean_fitness != 0.5) return 1;
+    }
+    tek::MetricsValues gone;
+    if (tek::Metrics::read(name, &gone)) return 1;
+    tek::Metrics::publish(gone);  // no-op without instance
+    return 0;
+}
@@ -1,6 +1,33 @@
 #include "population.hpp"
+#include "haploid.hpp"
+#include "transposon.hpp"
 
+#include <cmath>
 #include <iostream>
+#include <sstream>
+
+//! migrants per generation must be m N on average, and deme sizes must not change
+inline bool migration() {
+    constexpr size_t popsize = 300u;
+    constexpr size_t generations = 40u;
+    tek::PopulationParams params;
+    params.NUM_DEMES = 3u;
+    params.MIGRATION_RATE = 0.2;
+    tek::Population::param(params);
+    tek::Population::seed(42u);
+    tek::Population demes(popsize, popsize);
+    size_t total = 0u;
+    for (size_t t = 0u; t < generations; ++t) {
+        const auto sketch = demes.step();
+        if (demes.gametes().size() != 2u * popsize) return false;
+        if (sketch.count() != popsize) return false;
+        total += demes.num_migrants();
+    }
+    const double expected = params.MIGRATION_RATE * popsize * generations;
+    const double sd = std::sqrt(expected * (1.0 - params.MIGRATION_RATE));
+    std::cout << "migrants: " << total << " expected: " << expected << std::endl;
+    return std::abs(total - expected) < 4.0 * sd;
+}
 
 int main() {
     tek::Population pop(6, 6);
@@ -9,4 +36,59 @@ int main() {
     std::cout << pop << std::endl;
     pop.write_summary(std::cout);
     pop.write_fasta(std::cout);
+    std::stringstream snapshot;
+    pop.save(snapshot);
+    tek::Population loaded(snapshot);
+    std::ostringstream expected, actual;
+    pop.write_summary(expected);
+    loaded.write_summary(actual);
+    if (actual.str() != expected.str()) return 1;
+
+    tek::PopulationParams params;
+    params.NUM_DEMES = 3u;
+    params.MIGRATION_RATE = 0.5;
+    tek::Population::param(params);
+    tek::Population demes(12, 12);
+    demes.evolve(3u, -1u);
+    std::cout << demes << std::endl;
+    for (const auto* x: {&pop, &demes}) {
+        const auto& gametes = x->gametes();
+        tek::Census expected_counts;
+        uint_fast64_t transposons = 0u;
+        for (size_t i = 0u; i < gametes.size(); i += 2u) {
+            expected_counts.add(gametes[i], gametes[i + 1u]);
+            transposons += gametes[i].size() + gametes[i + 1u].size();
+        }
+        const auto& counts = x->counts();
+        if (counts.transposons != transposons) return 1;
+        if (counts.transposons != expected_counts.transposons) return 1;
+        if (counts.active != expected_counts.active) return 1;
+        if (counts.carriers != expected_counts.carriers) return 1;
+        if (counts.num_species() != expected_counts.num_species()) return 1;
+    }
+
+    if (!migration()) return 1;
+
+    tek::Transposon::initialize();
+    params.NUM_DEMES = 1u;
+    params.MIGRATION_RATE = 0.0;
+    params.ESTABLISH_COPIES = 10u;
+    tek::Population::param(params);
+    tek::Establishment results[2];
+    std::string summaries[2];
+    for (int i = 0; i < 2; ++i) {
+        tek::Population::seed(42u);
+        tek::Population founder(20, 1);
+        results[i] = founder.establish(20u);
+        std::ostringstream oss;
+        founder.write_summary(oss);
+        summaries[i] = oss.str();
+        std::cout << "attempt=" << results[i].attempt << " generations=" << results[i].generations
+                  << " copies=" << results[i].copies << std::endl;
+    }
+    if (results[0].generations == 0u) return 1;
+    if (results[0].copies < params.ESTABLISH_COPIES && results[0].generations < 20u) return 1;
+    if (results[0].attempt != results[1].attempt || results[0].seed != results[1].seed) return 1;
+    if (summaries[0] != summaries[1]) return 1;
+    return 0;
 }
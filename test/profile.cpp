@@ -0,0 +1,39 @@
+#include "profile.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+int main() {
+    tek::Profile::enabled(true);
+    std::thread worker([] {
+        tek::Stopwatch stopwatch;
+        tek::Profile::count(tek::Event::attempt, 3u);
+        stopwatch.lap(tek::Phase::sampling);
+        tek::Profile::merge();
+    });
+    worker.join();
+    tek::Profile::count(tek::Event::attempt);
+    tek::Profile::merge();
+    std::ostringstream oss;
+    tek::Profile::take().write(tek::Profile::write_header(oss), 1u);
+    std::cout << oss.str();
+#ifdef TEK_PROFILE
+    if (oss.str().find("\t4\t0\t") == std::string::npos) return 1;
+#endif
+
+    tek::PerfCounters::enabled(true);
+    {
+        tek::Stopwatch stopwatch;
+        volatile double x = 0.0;
+        for (int i = 0; i < 100000; ++i) x = x + i;
+        stopwatch.lap(tek::Phase::fitness);
+    }
+    tek::Profile::merge();
+    std::ostringstream counters;
+    tek::Profile::take().write_counters(counters);
+    std::cout << counters.str();
+    if (counters.str().compare(0u, 12u, "phase\tcycles") != 0) return 1;
+    if (counters.str().find("\nfitness\t") == std::string::npos) return 1;
+    return 0;
+}
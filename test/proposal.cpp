@@ -0,0 +1,94 @@
+#include "proposal.hpp"
+#include "transposon.hpp"
+
+#include <sfmt.hpp>
+#include <wtl/random.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <unordered_map>
+#include <random>
+#include <vector>
+
+//! fitness from GameteTable must be identical to that of the built gametes
+template <bool Speciation> inline
+bool same_fitness(const std::vector<tek::Haploid>& gametes, tek::Haploid::URBG& engine) {
+    tek::GameteTable table(gametes);
+    table.fill(0u, gametes.size() / 2u);
+    table.fill(gametes.size() / 2u, gametes.size());
+    std::uniform_int_distribution<size_t> dist_idx(0u, gametes.size() / 2u - 1u);
+    std::vector<tek::Haploid::position_t> chiasmata;
+    for (int i = 0; i < 400; ++i) {
+        tek::Proposal x;
+        x.mother = dist_idx(engine);
+        x.father = dist_idx(engine);
+        x.egg_flg = (wtl::generate_canonical(engine) < 0.5);
+        x.sperm_flg = (wtl::generate_canonical(engine) < 0.5);
+        chiasmata.clear();
+        x.egg_chiasmata = static_cast<uint32_t>(chiasmata.size());
+        const auto& egg_chiasmata = tek::Haploid::sample_chiasmata(engine);
+        chiasmata.insert(chiasmata.end(), egg_chiasmata.begin(), egg_chiasmata.end());
+        x.sperm_chiasmata = static_cast<uint32_t>(chiasmata.size());
+        const auto& sperm_chiasmata = tek::Haploid::sample_chiasmata(engine);
+        chiasmata.insert(chiasmata.end(), sperm_chiasmata.begin(), sperm_chiasmata.end());
+        const auto egg = gametes[2u * x.mother].gametogenesis(
+            gametes[2u * x.mother + 1u], x.egg_flg, &chiasmata[x.egg_chiasmata]);
+        const auto sperm = gametes[2u * x.father].gametogenesis(
+            gametes[2u * x.father + 1u], x.sperm_flg, &chiasmata[x.sperm_chiasmata]);
+        const double expected = egg.fitness<Speciation>(sperm);
+        const double observed = table.fitness<Speciation>(x, chiasmata);
+        if (observed != expected) {
+            std::cerr << "expected " << expected << " but got " << observed << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    tek::Haploid::initialize(500u, 0.01, 20000);
+    tek::Transposon::initialize();
+    tek::Haploid::URBG engine(42u);
+    auto founder = std::make_shared<tek::Transposon>();
+    auto other = std::make_shared<tek::Transposon>();
+    other->speciate();
+    tek::Transposon::INTERACTION_COEFS_emplace(founder->species(), other->species(), 0.5);
+    const std::vector<std::shared_ptr<tek::Transposon>> two_species{founder, other};
+
+    std::vector<tek::Haploid> single, mixed;
+    for (size_t i = 0u; i < 20u; ++i) {
+        single.emplace_back(i % 7u);
+        single.emplace_back(i % 5u);
+        mixed.emplace_back(i % 9u, two_species);
+        mixed.emplace_back(i % 4u, two_species);
+    }
+    // chromosomes sharing sites, so that recombination meets the same positions
+    for (size_t i = 0u; i < 6u; ++i) {
+        for (auto* gametes: {&single, &mixed}) {
+            const tek::Haploid x = gametes->back();
+            const tek::Haploid y(6u, (gametes == &mixed) ? two_species : decltype(two_species){});
+            const tek::Haploid z = x.gametogenesis(y, engine);
+            gametes->push_back(x);
+            gametes->push_back(z);
+            gametes->push_back(z);
+            gametes->push_back(y);
+        }
+    }
+    // the same sites occupied by the other species
+    const std::unordered_map<const tek::Transposon*, uint32_t> swap{{founder.get(), 1u}, {other.get(), 0u}};
+    for (size_t i = 0u; i < 6u; ++i) {
+        const tek::Haploid x(5u + i, two_species);
+        std::stringstream buffer;
+        x.write_binary(buffer, swap);
+        mixed.push_back(x);
+        mixed.push_back(tek::Haploid::read_binary(buffer, two_species));
+    }
+    for (const auto* gametes: {&single, &mixed}) {
+        for (const auto& x: *gametes) tek::Haploid::insert_coefs_gp(x, engine);
+    }
+    if (!same_fitness<false>(single, engine)) return 1;
+    if (!same_fitness<true>(single, engine)) return 1;
+    if (!same_fitness<true>(mixed, engine)) return 1;
+    return 0;
+}
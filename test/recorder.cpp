@@ -0,0 +1,33 @@
+#include "recorder.hpp"
+
+#include <wtl/zlib.hpp>
+
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main() {
+    const std::string filename = "tek-recorder.tsv.gz";
+    tek::Recorder recorder(2u);
+    for (int i=0; i<6; ++i) {
+        recorder.push([i, filename](tek::Recorder& rec) {
+            rec.stream(filename, "job\n") << i << "\n";
+        });
+    }
+    recorder.close();
+    {
+        wtl::zlib::ifstream ist(filename);
+        const std::string content(std::istreambuf_iterator<char>(ist), {});
+        std::cout << content;
+        if (content != "job\n0\n1\n2\n3\n4\n5\n") return 1;
+    }
+    tek::Recorder failing;
+    failing.push([](tek::Recorder&) {throw std::runtime_error("expected");});
+    try {
+        failing.close();
+        return 1;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "series.hpp"
+
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <map>
+#include <string>
+
+//! reconstruct sequences from rows of AlleleSeries::write()
+bool reconstruct(const std::string& rows, std::map<uint_fast64_t, std::string>* sequences) {
+    std::istringstream iss(rows);
+    std::string line;
+    while (std::getline(iss, line)) {
+        std::istringstream fields(line);
+        std::string generation, allele, parent, species, indel, hyperactive, dn, ds, activity, changes;
+        std::getline(fields, generation, '\t');
+        std::getline(fields, allele, '\t');
+        std::getline(fields, parent, '\t');
+        for (auto* x: {&species, &indel, &hyperactive, &dn, &ds, &activity}) {
+            std::getline(fields, *x, '\t');
+        }
+        std::getline(fields, changes, '\t');
+        std::string seq = (parent == "NA")
+          ? std::string(tek::LENGTH, 'A')
+          : sequences->at(std::stoull(parent));
+        std::istringstream change_iss(changes);
+        std::string change;
+        while (std::getline(change_iss, change, ',')) {
+            const size_t position = std::stoul(change.substr(0u, change.size() - 1u));
+            seq.at(position - 1u) = change.back();
+        }
+        if (!sequences->emplace(std::stoull(allele), seq).second) return false;
+    }
+    return true;
+}
+
+std::string encode(const tek::Transposon& te) {
+    char buffer[tek::LENGTH];
+    te.encode_sequence(buffer);
+    return std::string(buffer, tek::LENGTH);
+}
+
+int main() {
+    std::mt19937_64 engine(42u);
+    tek::Transposon::initialize();
+    tek::Transposon a;
+    for (int i = 0; i < 20; ++i) a.mutate(engine);
+    tek::Transposon b(a);
+    for (int i = 0; i < 3; ++i) b.mutate(engine);
+    tek::Transposon c = b;
+    for (int i = 0; i < 2; ++i) c.mutate(engine);
+    using individual_type = tek::AlleleSeries::individual_type;
+
+    tek::AlleleSeries series;
+    std::map<uint_fast64_t, std::string> sequences;
+    std::ostringstream alleles1, copies1;
+    series.write(alleles1, copies1, 10u, {a, b, a},
+                 {individual_type{{0u, 2u}, {1u, 1u}}, individual_type{{2u, 1u}}});
+    std::cout << alleles1.str() << copies1.str();
+    if (!reconstruct(alleles1.str(), &sequences)) return 1;
+    if (sequences.size() != 2u) return 1;
+    if (sequences.at(0u) != encode(a) || sequences.at(1u) != encode(b)) return 1;
+    if (copies1.str() != "10\t0\t0\t2\n10\t0\t1\t1\n10\t1\t0\t1\n") return 1;
+
+    std::ostringstream alleles2, copies2;
+    series.write(alleles2, copies2, 20u, {c, b}, {individual_type{{0u, 1u}, {1u, 3u}}});
+    std::cout << alleles2.str() << copies2.str();
+    if (alleles2.str().find("20\t2\t1\t") != 0u) return 1;
+    if (!reconstruct(alleles2.str(), &sequences)) return 1;
+    if (sequences.size() != 3u) return 1;
+    if (sequences.at(2u) != encode(c)) return 1;
+    if (copies2.str() != "20\t0\t1\t3\n20\t0\t2\t1\n") return 1;
+
+    // `a` reappears with its ID; `e` descends from `d` of the same record
+    tek::Transposon d = a;
+    for (int i = 0; i < 2; ++i) d.mutate(engine);
+    tek::Transposon e = d;
+    e.mutate(engine);
+    std::ostringstream alleles3, copies3;
+    series.write(alleles3, copies3, 30u, {d, a, e}, {individual_type{{0u, 1u}, {1u, 1u}, {2u, 1u}}});
+    std::cout << alleles3.str() << copies3.str();
+    if (alleles3.str().find("30\t3\t0\t") != 0u) return 1;
+    if (alleles3.str().find("\n30\t4\t3\t") == std::string::npos) return 1;
+    if (!reconstruct(alleles3.str(), &sequences)) return 1;
+    if (sequences.size() != 5u) return 1;
+    if (sequences.at(3u) != encode(d) || sequences.at(4u) != encode(e)) return 1;
+    if (copies3.str() != "30\t0\t0\t1\n30\t0\t3\t1\n30\t0\t4\t1\n") return 1;
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "simulation.hpp"
+#include "statistics.hpp"
+
+#include <iostream>
+#include <sstream>
+
+int main() {
+    tek::SimulationParams params;
+    params.POPSIZE = 40u;
+    params.NUM_FOUNDERS = 40u;
+    params.SEED = 1u;
+    tek::Simulation sim(params);
+    std::vector<size_t> observed;
+    size_t num_calls = 0u;
+    sim.observe([&observed](const tek::Observation& x) {
+        observed.push_back(x.generation());
+        if (x.gametes().size() != 80u) throw std::logic_error("gametes");
+        if (x.fitness().size() != 40u) throw std::logic_error("fitness");
+        std::cout << x.generation() << "\t" << x.statistics().num_transposons() << std::endl;
+    }, 5u);
+    sim.observe([&num_calls](const tek::Observation& x) {
+        ++num_calls;
+        x.statistics();
+    });
+    const bool alive = sim.run(20u);
+    std::cout << "alive: " << alive << std::endl;
+    if (num_calls != sim.generation()) return 1;
+    for (size_t i = 0u; i < observed.size(); ++i) {
+        if (observed[i] != 5u * (i + 1u)) return 1;
+    }
+    if (alive && observed.size() != 4u) return 1;
+
+    std::stringstream snapshot;
+    sim.population().save(snapshot);
+    tek::Simulation resumed(params, snapshot);
+    if (resumed.generation() != 0u) return 1;
+    if (resumed.population().gametes().size() != 80u) return 1;
+    resumed.step();
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "sitefreq.hpp"
+#include "haploid.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <map>
+
+int main() {
+    tek::Haploid::initialize(100u, 0.01, 20000);
+    std::vector<tek::Haploid> gametes;
+    for (size_t i = 0u; i < 6u; ++i) {
+        gametes.emplace_back(i);
+        gametes.push_back(gametes.back());
+    }
+    std::map<tek::Haploid::position_t, uint_fast32_t> expected_counts;
+    for (const auto& gamete: gametes) {
+        for (const auto& p: gamete) ++expected_counts[p.first];
+    }
+    std::map<uint_fast32_t, uint_fast64_t> expected_spectrum;
+    for (const auto& p: expected_counts) ++expected_spectrum[p.second];
+
+    tek::SiteFrequency whole(gametes, 0u, gametes.size());
+    tek::SiteFrequency merged(gametes, 0u, 5u);
+    merged += tek::SiteFrequency(gametes, 5u, 7u);
+    merged += tek::SiteFrequency();
+    merged += tek::SiteFrequency(gametes, 7u, gametes.size());
+    if (merged.num_sites() != expected_counts.size()) return 1;
+    if (merged.num_gametes() != gametes.size()) return 1;
+
+    std::ostringstream expected, whole_oss, merged_oss;
+    for (const auto& p: expected_spectrum) {
+        expected << 1u << "\t" << p.first << "\t" << p.second << "\n";
+    }
+    whole.write_spectrum(whole_oss, 1u);
+    merged.write_spectrum(merged_oss, 1u);
+    std::cout << merged_oss.str();
+    if (whole_oss.str() != expected.str()) return 1;
+    if (merged_oss.str() != expected.str()) return 1;
+
+    std::ostringstream top;
+    merged.write_top(top, 1u, 3u);
+    std::cout << top.str();
+    std::istringstream iss(top.str());
+    size_t generation, rank, gametes_carrying, num_rows = 0u;
+    tek::Haploid::position_t position;
+    double frequency;
+    uint_fast32_t previous = gametes.size();
+    while (iss >> generation >> rank >> position >> gametes_carrying >> frequency) {
+        if (rank != ++num_rows) return 1;
+        if (expected_counts.at(position) != gametes_carrying) return 1;
+        if (gametes_carrying > previous) return 1;
+        previous = gametes_carrying;
+    }
+    if (num_rows != 3u) return 1;
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "sketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+int main() {
+    std::mt19937_64 engine(42u);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> values;
+    tek::FitnessSketch whole;
+    std::vector<tek::FitnessSketch> parts(4u);
+    for (size_t i = 0u; i < 10000u; ++i) {
+        const double x = (i % 100u == 0u) ? 1.0 : 1.0 - std::pow(uniform(engine), 3.0);
+        values.push_back(x);
+        whole.add(x);
+        parts[i % parts.size()].add(x);
+    }
+    tek::FitnessSketch merged;
+    merged += tek::FitnessSketch();
+    for (const auto& x: parts) merged += x;
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (const double x: values) sum += x;
+    const double mean = sum / values.size();
+    double ss = 0.0;
+    for (const double x: values) ss += (x - mean) * (x - mean);
+    const double variance = ss / (values.size() - 1u);
+
+    for (const auto* sketch: {&whole, &merged}) {
+        if (sketch->count() != values.size()) return 1;
+        if (std::abs(sketch->mean() - mean) > 1e-12) return 1;
+        if (std::abs(sketch->variance() - variance) > 1e-12) return 1;
+        if (sketch->min() != values.front() || sketch->max() != values.back()) return 1;
+        for (const double q: {0.0, 0.005, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.999, 1.0}) {
+            const double expected = values[static_cast<size_t>(std::ceil(q * (values.size() - 1u)))];
+            const double estimate = sketch->quantile(q);
+            if (std::abs(estimate - expected) > tek::FitnessSketch::ACCURACY * (1.0 - expected) + 1e-15) {
+                std::cerr << q << " " << expected << " " << estimate << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::ostringstream whole_oss, merged_oss;
+    whole.write(whole_oss, 1u);
+    merged.write(merged_oss, 1u);
+    std::cout << tek::FitnessSketch::header() << merged_oss.str();
+    if (whole_oss.str() != merged_oss.str()) return 1;
+    if (!std::isnan(tek::FitnessSketch().quantile(0.5))) return 1;
+    return 0;
+}
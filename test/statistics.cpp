@@ -0,0 +1,24 @@
+#include "statistics.hpp"
+#include "haploid.hpp"
+
+#include <iostream>
+
+int main() {
+    tek::Transposon::initialize();
+    tek::Haploid::initialize(500u, 0.01, 20000);
+    tek::Statistics stats(true);
+    stats.collect(tek::Haploid(3u), tek::Haploid(5u));
+    tek::Statistics other;
+    other.collect(tek::Haploid(), tek::Haploid(2u));
+    other.collect(tek::Haploid(1u), tek::Haploid(1u));
+    stats += other;
+    std::cout << tek::Statistics::activity_header();
+    stats.write_activity(std::cout, 1u);
+    std::cout << tek::Statistics::species_header();
+    stats.write_species(std::cout, 1u);
+    std::cout << tek::Statistics::copy_number_header();
+    stats.write_copy_number(std::cout, 1u);
+    if (stats.num_transposons() != 12u) return 1;
+    if (stats.families().at(0u).size() != 8u) return 1;
+    return 0;
+}
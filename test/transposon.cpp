@@ -3,6 +3,7 @@
 #include <random>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 inline void activity_function() {
     std::ofstream ofs("tek-activity_function.tsv");
@@ -19,6 +20,20 @@ inline void activity_function() {
     */
 }
 
+inline void encode_sequence(const tek::Transposon& x) {
+    std::ostringstream expected;
+    for (uint_fast32_t in=0u, is=0u; in<tek::Transposon::NUM_NONSYNONYMOUS_SITES; ++in, ++is) {
+        expected << x.nonsynonymous_sites()[in];
+        expected << x.nonsynonymous_sites()[++in];
+        expected << x.synonymous_sites()[is];
+    }
+    std::ostringstream encoded;
+    x.write_sequence(encoded);
+    if (encoded.str() != expected.str()) {
+        throw std::runtime_error("encode_sequence() is broken");
+    }
+}
+
 int main() {
     std::mt19937 mt(std::random_device{}());
     tek::Transposon::initialize();
@@ -30,6 +45,8 @@ int main() {
     mut.indel();
     std::cout << mut << std::endl;
     std::cout << "Hamming distance: " << mut - wt << std::endl;
+    for (int i=0; i<200; ++i) mut.mutate(mt);
+    encode_sequence(mut);
     tek::TransposonFamily family;
     family.collect(wt);
     family.collect(wt);